@@ -27,7 +27,9 @@ import sys
 
 __all__ = [
     'img_to_bui_bitmap',
+    'img_to_packed_screen',
     'format_data',
+    'format_packed_screen',
 ]
 
 def hexbyte(b):
@@ -113,6 +115,45 @@ def img_to_bui_bitmap(img):
     # Done
     return w, h, b, palette, bpp
 
+def packbits(data):
+    packed = []
+    i = 0
+    while i < len(data):
+        # Measure the run of identical bytes starting at i
+        run = 1
+        while i + run < len(data) and run < 128 and data[i + run] == data[i]:
+            run += 1
+        if run >= 2:
+            packed.append(257 - run)
+            packed.append(data[i])
+            i += run
+            continue
+        # Collect literal bytes until the next run of identical bytes
+        j = i + 1
+        while j < len(data) and j - i < 128 and not (j + 1 < len(data) and data[j] == data[j + 1]):
+            j += 1
+        packed.append(j - i - 1)
+        packed.extend(data[i:j])
+        i = j
+    return packed
+
+def img_to_packed_screen(img):
+    w, h, b, p, bpp = img_to_bui_bitmap(img)
+    if w != 128 or h != 32:
+        raise RuntimeError("Image must be 128x32")
+    colors = [int(c, 16) & 0xFFFFFF for c in p]
+    if any(c not in [0x000000, 0xFFFFFF] for c in colors):
+        raise RuntimeError("Image must only contain black and white")
+    if bpp == 0:
+        data = [0xFF if colors[0] != 0 else 0x00] * 512
+    else:
+        # The display status payloads for the entire display are the display buffer's bytes in reverse order
+        data = [int(byte, 16) for byte in reversed(b)]
+    packed = []
+    for i in range(0, 512, 64):
+        packed.extend(packbits(data[i:i+64]))
+    return [hexbyte(byte) for byte in packed]
+
 def format_data(prefix, w, h, b, p, bpp):
     s = ''
     s += 'const uint8_t ' + prefix + '_w = ' + str(w) + ';\n'
@@ -135,30 +176,49 @@ def format_data(prefix, w, h, b, p, bpp):
     s += 'const uint8_t ' + prefix + '_bpp = ' + str(bpp) + ';\n'
     return s
 
+def format_packed_screen(prefix, b):
+    s = ''
+    s += 'const uint8_t ' + prefix + '_packed[] = {'
+    for i in range(len(b)):
+        if i % 8 == 0:
+            s += '\n    '
+        else:
+            s += ' '
+        s += '0x' + b[i].upper() + ','
+    s += '\n};\n'
+    return s
+
 def usage():
-    sys.stderr.write("Usage: python " + sys.argv[0] + " <filename> [prefix]\n")
+    sys.stderr.write("Usage: python " + sys.argv[0] + " [--packed] <filename> [prefix]\n")
 
 def main():
     if len(sys.argv) == 0:
         sys.stderr.write("Invalid arguments\n")
         sys.exit(1)
-    if len(sys.argv) not in [2, 3]:
+    args = sys.argv[1:]
+    packed = len(args) != 0 and args[0] == '--packed'
+    if packed:
+        args = args[1:]
+    if len(args) not in [1, 2]:
         usage()
         sys.exit(1)
     try:
-        img = Image.open(sys.argv[1])
+        img = Image.open(args[0])
         img.load()
     except FileNotFoundError:
-        sys.stderr.write("Error: File '" + sys.argv[1] + "' not found\n")
+        sys.stderr.write("Error: File '" + args[0] + "' not found\n")
         usage()
         sys.exit(1)
-    w, h, b, p, bpp = img_to_bui_bitmap(img)
-    prefix = ('app_bmp_' + os.path.splitext(os.path.basename(sys.argv[1]))[0]) if len(sys.argv) != 3 else sys.argv[2]
+    prefix = ('app_bmp_' + os.path.splitext(os.path.basename(args[0]))[0]) if len(args) != 2 else args[1]
     prefix = prefix.replace('-', '_')
     prefix = re.sub('[^a-zA-Z0-9_]', '', prefix)
     if len(prefix) == 0:
         prefix = 'app_bmp'
-    sys.stdout.write(format_data(prefix, w, h, b, p, bpp))
+    if packed:
+        sys.stdout.write(format_packed_screen(prefix, img_to_packed_screen(img)))
+    else:
+        w, h, b, p, bpp = img_to_bui_bitmap(img)
+        sys.stdout.write(format_data(prefix, w, h, b, p, bpp))
 
 if __name__ == '__main__':
     main()
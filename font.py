@@ -0,0 +1,398 @@
+# License for the BOLOS User Interface Library project, originally found here:
+# https://github.com/parkerhoyes/bolos-user-interface
+#
+# Copyright (C) 2017 Parker Hoyes <contact@parkerhoyes.com>
+#
+# This software is provided "as-is", without any express or implied warranty. In
+# no event will the authors be held liable for any damages arising from the use
+# of this software.
+#
+# Permission is granted to anyone to use this software for any purpose,
+# including commercial applications, and to alter it and redistribute it freely,
+# subject to the following restrictions:
+#
+# 1. The origin of this software must not be misrepresented; you must not claim
+#    that you wrote the original software. If you use this software in a
+#    product, an acknowledgment in the product documentation would be
+#    appreciated but is not required.
+# 2. Altered source versions must be plainly marked as such, and must not be
+#    misrepresented as being the original software.
+# 3. This notice may not be removed or altered from any source distribution.
+
+# This script reads a font in the format of the font files in src/fonts/ (as included by src/bui_font_fonts.inc) and
+# writes it back out, optionally converting it to another storage format supported by the font module and optionally
+# keeping only a subset of its characters. The subset may be given explicitly, or it may be found by scanning the string
+# and character literals in an application's source files. A subset font file may replace the font file included with
+# the library by defining the macro BUI_FONT_SUBSET_<FONT NAME> as its path in quotes (see src/bui_font_fonts.inc).
+#
+# With --render, this script instead reads a table of constant strings, each to be drawn in a particular font, and
+# writes C source code defining a bui_font_text_t for each string, holding its bitmap and metrics as rendered by the
+# font module (see bui_font_draw_text(...)). Every line of the table that isn't blank or a comment (starting with '#')
+# has the form:
+#     <name> <font> <string>
+# where name is the name of the bui_font_text_t constant to be defined, font is the name of one of the fonts in
+# src/fonts/ (such as open_sans_bold_13) or the path of a font file, and string is a C string literal.
+#
+# A font is represented as a dict with the following keys:
+#     'name': the name of the font, such as 'lucida_console_8'
+#     'header': the text preceding the font's data in its file (the license and notices), or '' if none
+#     'char_height', 'baseline_height', 'char_kerning': the values of the fields in bui_font_info_t
+#     'glyphs': a list of glyphs ordered by character code, each a dict with the following keys:
+#         'code': the character code
+#         'width': the width of the glyph, in pixels
+#         'rows': a list of strings of '0' and '1', one per row from top to bottom, each with one character per column
+#                 from left to right
+#     'aligned', 'compressed': True if the font was stored with BUI_FONT_FLAG_ALIGNED_ROWS or
+#                              BUI_FONT_FLAG_COMPRESSED_ROWS, respectively
+
+import os
+import re
+import sys
+
+__all__ = [
+    'parse_font',
+    'decode_text',
+    'scan_source',
+    'subset_font',
+    'encode_glyph',
+    'format_font',
+    'render_text',
+    'format_texts',
+]
+
+def hexbyte(b):
+    return hex(0x100 + b)[-2:]
+
+def hexcode(code):
+    return '0x' + (hex(0x100 + code)[-2:] if code <= 0xFF else hex(0x10000 + code)[-4:]).upper()
+
+def bytes_to_bits(byts):
+    return ''.join(bin(0x100 + b)[-8:] for b in byts)
+
+def bits_to_bytes(bits):
+    bits += '0' * (-len(bits) % 8)
+    return [int(bits[i:i+8], 2) for i in range(0, len(bits), 8)]
+
+def parse_font(text):
+    m = re.search(r'static const uint8_t bui_font_(\w+)_bitmaps\[\] = \{(.*?)\n\};', text, re.S)
+    if m is None:
+        raise RuntimeError("Font bitmaps not found")
+    name = m.group(1)
+    header = text[:m.start()]
+    bitmaps = [int(b, 16) for b in re.findall(r'0x([0-9A-Fa-f]{2})', re.sub(r'//.*', '', m.group(2)))]
+    m = re.search(r'bui_font_' + name + r'_characters\[\] = \{(.*?)\n\};', text, re.S)
+    if m is None:
+        raise RuntimeError("Font characters not found")
+    chars = re.findall(r'\{(\d+), (\d+)(?:, (\d+), (\d+))?\}, // character code 0x([0-9A-Fa-f]+)', m.group(1))
+    m = re.search(r'bui_font_data_' + name + r' = \{.*?\{(\d+), (\d+), (\d+), 0x([0-9A-Fa-f]+), 0x([0-9A-Fa-f]+)'
+            r'(?:, ([\w |]+))?\}', text, re.S)
+    if m is None:
+        raise RuntimeError("Font info not found")
+    h = int(m.group(1))
+    flags = m.group(6) or ''
+    aligned = 'ALIGNED_ROWS' in flags
+    compressed = 'COMPRESSED_ROWS' in flags
+    glyphs = []
+    for offset, w, ink_y, ink_h, code in chars:
+        offset, w, code = int(offset), int(w), int(code, 16)
+        # Fonts without ink bounding boxes store every row
+        ink_y, ink_h = (int(ink_y), int(ink_h)) if ink_h != '' else (0, h)
+        stride = (w + 7) // 8 * 8 if aligned else w
+        if compressed:
+            repeats = bytes_to_bits(bitmaps[offset:offset + (ink_h + 7) // 8])[:ink_h]
+            offset += (ink_h + 7) // 8
+        else:
+            repeats = '0' * ink_h
+        bits = bytes_to_bits(bitmaps[offset:offset + (stride * repeats.count('0') + 7) // 8])
+        # Bitmaps are stored with both their rows and columns reversed, in the same orientation as the display buffer
+        rows = []
+        row = '0' * w
+        for repeat in repeats:
+            if repeat == '0':
+                row = bits[:w][::-1]
+                bits = bits[stride:]
+            rows.append(row)
+        rows.reverse()
+        rows = ['0' * w] * ink_y + rows + ['0' * w] * (h - ink_y - ink_h)
+        glyphs.append({'code': code, 'width': w, 'rows': rows})
+    return {
+        'name': name,
+        'header': header,
+        'char_height': h,
+        'baseline_height': int(m.group(2)),
+        'char_kerning': int(m.group(3)),
+        'glyphs': glyphs,
+        'aligned': aligned,
+        'compressed': compressed,
+    }
+
+def decode_text(byts):
+    # Decode text the same way as the font module: as UTF-8 with sequences of at most 3 bytes, where every byte that
+    # does not begin a valid sequence is decoded by itself as Latin-1
+    codes = []
+    i = 0
+    while i < len(byts):
+        lead = byts[i]
+        if 0xC2 <= lead <= 0xDF and len(byts) - i >= 2 and byts[i+1] & 0xC0 == 0x80:
+            codes.append(((lead & 0x1F) << 6) | (byts[i+1] & 0x3F))
+            i += 2
+            continue
+        if 0xE0 <= lead <= 0xEF and len(byts) - i >= 3 and byts[i+1] & 0xC0 == 0x80 and byts[i+2] & 0xC0 == 0x80:
+            code = ((lead & 0x0F) << 12) | ((byts[i+1] & 0x3F) << 6) | (byts[i+2] & 0x3F)
+            # Overlong encodings are rejected
+            if code >= 0x800:
+                codes.append(code)
+                i += 3
+                continue
+        codes.append(lead)
+        i += 1
+    return codes
+
+ESCAPES = {
+    'n': 0x0A, 't': 0x09, 'r': 0x0D, 'a': 0x07, 'b': 0x08, 'f': 0x0C, 'v': 0x0B,
+    '\\': 0x5C, "'": 0x27, '"': 0x22, '?': 0x3F,
+}
+
+def unescape_literal(body):
+    byts = []
+    i = 0
+    while i < len(body):
+        if body[i] != '\\':
+            byts.extend(body[i].encode('utf-8', 'surrogateescape'))
+            i += 1
+            continue
+        m = re.match(r'\\(x[0-9A-Fa-f]+|[0-7]{1,3}|u[0-9A-Fa-f]{4}|U[0-9A-Fa-f]{8}|.)', body[i:], re.S)
+        esc = m.group(1)
+        if esc[0] == 'x':
+            byts.append(int(esc[1:], 16) & 0xFF)
+        elif esc[0] in '01234567':
+            byts.append(int(esc, 8) & 0xFF)
+        elif esc[0] in 'uU':
+            byts.extend(chr(int(esc[1:], 16)).encode('utf-8'))
+        else:
+            byts.append(ESCAPES.get(esc, ord(esc[0]) & 0xFF))
+        i += len(m.group(0))
+    return byts
+
+def scan_source(text):
+    # Find the characters in every string and character literal in C source code, skipping comments
+    codes = set()
+    for m in re.finditer(r'//[^\n]*|/\*.*?\*/|"((?:\\.|[^"\\\n])*)"|\'((?:\\.|[^\'\\\n])*)\'', text, re.S):
+        body = m.group(1) if m.group(1) is not None else m.group(2)
+        if body is not None:
+            codes.update(decode_text(unescape_literal(body)))
+    return codes
+
+def subset_font(font, codes):
+    subset = dict(font)
+    subset['glyphs'] = [glyph for glyph in font['glyphs'] if glyph['code'] in codes]
+    if len(subset['glyphs']) == 0:
+        raise RuntimeError("Subset of font '" + font['name'] + "' is empty")
+    return subset
+
+def ink_bounds(glyph):
+    ink = [y for y, row in enumerate(glyph['rows']) if '1' in row]
+    if len(ink) == 0:
+        return 0, 0
+    return ink[0], ink[-1] + 1 - ink[0]
+
+def encode_glyph(glyph, aligned=False, compressed=False):
+    # Only the rows within the glyph's ink bounding box are stored
+    ink_y, ink_h = ink_bounds(glyph)
+    repeats = ''
+    bits = ''
+    prev = '0' * glyph['width']
+    for row in reversed(glyph['rows'][ink_y:ink_y + ink_h]):
+        if compressed and row == prev:
+            repeats += '1'
+            continue
+        repeats += '0'
+        prev = row
+        bits += row[::-1]
+        if aligned:
+            bits += '0' * (-len(bits) % 8)
+    return (bits_to_bytes(repeats) if compressed else []) + bits_to_bytes(bits)
+
+def format_font(font, aligned=False, compressed=False):
+    name = font['name']
+    glyphs = font['glyphs']
+    s = font['header']
+    s += 'static const uint8_t bui_font_' + name + '_bitmaps[] = {\n'
+    # Characters with identical encoded bitmaps share a single copy of the bitmap; this holds even if their widths
+    # differ, since every character's bitmap is decoded using its own width
+    offsets = []
+    offset = 0
+    shared = {}
+    for glyph in glyphs:
+        b = encode_glyph(glyph, aligned, compressed)
+        if tuple(b) in shared:
+            offsets.append(shared[tuple(b)])
+            continue
+        shared[tuple(b)] = offset
+        offsets.append(offset)
+        offset += len(b)
+        s += '\t// character code ' + hexcode(glyph['code']) + '\n'
+        for i in range(0, len(b), 8):
+            s += '\t' + ' '.join('0x' + hexbyte(byte).upper() + ',' for byte in b[i:i+8]) + '\n'
+    s += '};\n\n'
+    if offset > 0x10000:
+        raise RuntimeError("Font bitmaps too large")
+    s += 'static const bui_font_char_t bui_font_' + name + '_characters[] = {\n'
+    for glyph, offset in zip(glyphs, offsets):
+        ink_y, ink_h = ink_bounds(glyph)
+        s += '\t{' + str(offset) + ', ' + str(glyph['width']) + ', ' + str(ink_y) + ', ' + str(ink_h) + '}, '
+        s += '// character code ' + hexcode(glyph['code']) + '\n'
+    s += '};\n\n'
+    # Consecutive character codes are grouped into ranges
+    ranges = []
+    for i, glyph in enumerate(glyphs):
+        if len(ranges) != 0 and ranges[-1][1] + 1 == glyph['code']:
+            ranges[-1][1] = glyph['code']
+        else:
+            ranges.append([glyph['code'], glyph['code'], i])
+    if len(ranges) > 255:
+        raise RuntimeError("Font has too many ranges of characters")
+    s += 'static const bui_font_range_t bui_font_' + name + '_ranges[] = {\n'
+    for first, last, index in ranges:
+        s += '\t{' + hexcode(first) + ', ' + hexcode(last) + ', ' + str(index) + '},\n'
+    s += '};\n\n'
+    s += 'static const bui_font_data_t bui_font_data_' + name + ' = {\n'
+    s += '\tbui_font_' + name + '_characters,\n'
+    s += '\tbui_font_' + name + '_bitmaps,\n'
+    s += '\t{' + str(font['char_height']) + ', ' + str(font['baseline_height']) + ', ' + str(font['char_kerning'])
+    s += ', ' + hexcode(glyphs[0]['code']) + ', ' + hexcode(glyphs[-1]['code'])
+    flags = []
+    if aligned:
+        flags.append('BUI_FONT_FLAG_ALIGNED_ROWS')
+    if compressed:
+        flags.append('BUI_FONT_FLAG_COMPRESSED_ROWS')
+    s += ', ' + (' | '.join(flags) if len(flags) != 0 else '0')
+    s += '},\n'
+    s += '\tbui_font_' + name + '_ranges,\n'
+    s += '\t' + str(len(ranges)) + ',\n'
+    s += '};\n'
+    return s
+
+def render_text(font, byts):
+    # Render text the same way as the font module, returning the width of the text (including the kerning after the
+    # last character), the width of its bitmap, its ink bounds, and the bitmap of the rows within its ink bounds,
+    # encoded like the display buffer
+    glyphs = {glyph['code']: glyph for glyph in font['glyphs']}
+    placed = []
+    w = 0
+    for code in decode_text(byts):
+        if code in glyphs:
+            placed.append((w, glyphs[code]))
+            w += glyphs[code]['width'] + font['char_kerning']
+    if w >= 1023:
+        raise RuntimeError("Text too wide")
+    bb_w = max(w - font['char_kerning'], 0)
+    rows = [['0'] * bb_w for y in range(font['char_height'])]
+    for x, glyph in placed:
+        for y, row in enumerate(glyph['rows']):
+            for col, bit in enumerate(row):
+                if bit == '1':
+                    rows[y][x + col] = '1'
+    rows = [''.join(row) for row in rows]
+    ink_y, ink_h = ink_bounds({'rows': rows})
+    bits = ''.join(row[::-1] for row in reversed(rows[ink_y:ink_y + ink_h]))
+    return w, bb_w, ink_y, ink_h, bits_to_bytes(bits)
+
+def format_texts(table, font_dir):
+    s = '#include "bui_font.h"\n\n#include <stddef.h>\n'
+    fonts = {}
+    for line in table.splitlines():
+        if line.strip() == '' or line.strip().startswith('#'):
+            continue
+        m = re.fullmatch(r'\s*(\w+)\s+(\S+)\s+"((?:\\.|[^"\\])*)"\s*', line)
+        if m is None:
+            raise RuntimeError("Invalid line in table: " + line)
+        name, font_name, literal = m.groups()
+        if font_name not in fonts:
+            path = font_name if '/' in font_name else os.path.join(font_dir, 'bui_font_' + font_name + '.inc')
+            fonts[font_name] = parse_font(read_file(path))
+        font = fonts[font_name]
+        w, bb_w, ink_y, ink_h, b = render_text(font, unescape_literal(literal))
+        # Bytes that aren't ASCII are escaped in the comment, since they may not be valid UTF-8
+        comment = ''.join(chr(b) if b < 0x80 else '\\x' + hexbyte(b).upper()
+                for b in literal.encode('utf-8', 'surrogateescape'))
+        s += '\n// "' + comment + '" in ' + font['name'] + '\n'
+        # A string with no ink has no bitmap, since C doesn't allow an empty array
+        if ink_h != 0:
+            s += 'static const uint8_t ' + name + '_bb[] = {\n'
+            for i in range(0, len(b), 8):
+                s += '\t' + ' '.join('0x' + hexbyte(byte).upper() + ',' for byte in b[i:i+8]) + '\n'
+            s += '};\n'
+        bb = name + '_bb' if ink_h != 0 else 'NULL'
+        s += 'const bui_font_text_t ' + name + ' = {' + bb + ', ' + str(w) + ', ' + str(bb_w) + ', ' + str(ink_y)
+        s += ', ' + str(ink_h) + ', ' + str(font['baseline_height']) + '};\n'
+    return s
+
+def usage():
+    sys.stderr.write("Usage: python " + sys.argv[0] + " [options] <filename>\n")
+    sys.stderr.write("       python " + sys.argv[0] + " --render <table filename>\n")
+    sys.stderr.write("  --packed         store the bits of every glyph bitmap in one continuous sequence\n")
+    sys.stderr.write("  --aligned        pad every row of every glyph bitmap to a whole number of bytes\n")
+    sys.stderr.write("  --compressed     store each row of every glyph bitmap only if it differs from the previous\n")
+    sys.stderr.write("                   row\n")
+    sys.stderr.write("  --chars <chars>  keep the specified characters (may be repeated)\n")
+    sys.stderr.write("  --scan <file>    keep the characters in the string and character literals in a C source\n")
+    sys.stderr.write("                   file (may be repeated)\n")
+    sys.stderr.write("The storage format of the font is kept unless --packed, --aligned, or --compressed is\n")
+    sys.stderr.write("specified. If --chars or --scan is specified, only the characters specified are kept.\n")
+
+def read_file(path, binary=False):
+    try:
+        with open(path, 'rb' if binary else 'r') as f:
+            return f.read()
+    except FileNotFoundError:
+        sys.stderr.write("Error: File '" + path + "' not found\n")
+        usage()
+        sys.exit(1)
+
+def main():
+    args = sys.argv[1:]
+    if len(args) != 0 and args[0] == '--render':
+        if len(args) != 2:
+            usage()
+            sys.exit(1)
+        font_dir = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'src', 'fonts')
+        sys.stdout.write(format_texts(read_file(args[1], True).decode('utf-8', 'surrogateescape'), font_dir))
+        return
+    aligned = None
+    compressed = None
+    codes = None
+    while len(args) != 0 and args[0].startswith('--'):
+        if args[0] == '--packed':
+            aligned = False
+            compressed = False
+        elif args[0] == '--aligned':
+            aligned = True
+            compressed = compressed or False
+        elif args[0] == '--compressed':
+            aligned = aligned or False
+            compressed = True
+        elif args[0] in ['--chars', '--scan'] and len(args) >= 2:
+            codes = codes or set()
+            if args[0] == '--chars':
+                codes.update(decode_text(args[1].encode('utf-8', 'surrogateescape')))
+            else:
+                codes.update(scan_source(read_file(args[1], True).decode('utf-8', 'surrogateescape')))
+            args = args[1:]
+        else:
+            usage()
+            sys.exit(1)
+        args = args[1:]
+    if len(args) != 1:
+        usage()
+        sys.exit(1)
+    font = parse_font(read_file(args[0]))
+    if aligned is None:
+        aligned = font['aligned']
+        compressed = font['compressed']
+    if codes is not None:
+        font = subset_font(font, codes)
+    sys.stdout.write(format_font(font, aligned, compressed))
+
+if __name__ == '__main__':
+    main()
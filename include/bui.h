@@ -29,6 +29,37 @@
 
 _Static_assert(sizeof(uint8_t) == 1, "sizeof(uint8_t) must be 1");
 
+// The number of rows of the display that a BUI context's display buffer holds at once. By default, the display buffer
+// holds the entire display (32 rows, which requires 512 bytes). If this is defined as 1, 2, or 4 (consistently for the
+// application and for this library), BUI contexts operate in "band mode": the display buffer holds only a band of
+// BUI_CTX_BAND_ROWS rows (16 bytes per row), and frames are drawn by a draw callback (see
+// bui_ctx_set_draw_callback(...)) that is invoked once for every band of every frame. Anything drawn while a band is
+// being drawn is clipped to that band, and each band is sent to the MCU in a single display status as soon as it has
+// been drawn. This reduces the RAM used by a BUI context considerably, at the cost of invoking the draw callback
+// 32 / BUI_CTX_BAND_ROWS times per frame.
+#ifndef BUI_CTX_BAND_ROWS
+#define BUI_CTX_BAND_ROWS 32
+#endif
+
+_Static_assert(BUI_CTX_BAND_ROWS == 32 || BUI_CTX_BAND_ROWS == 1 || BUI_CTX_BAND_ROWS == 2 || BUI_CTX_BAND_ROWS == 4,
+		"BUI_CTX_BAND_ROWS must be 1, 2, 4, or 32");
+
+// The maximum number of SEPROXYHAL button push and ticker events that may be queued in a BUI context at once (see
+// bui_ctx_queue_seproxyhal_event(...)); consecutive ticker events only occupy a single slot
+#ifndef BUI_CTX_EVENT_QUEUE_SIZE
+#define BUI_CTX_EVENT_QUEUE_SIZE 4
+#endif
+
+_Static_assert(BUI_CTX_EVENT_QUEUE_SIZE >= 1 && BUI_CTX_EVENT_QUEUE_SIZE <= 255,
+		"BUI_CTX_EVENT_QUEUE_SIZE must be in [1, 255]");
+
+// The number of timers in a BUI context (see bui_ctx_set_timer(...))
+#ifndef BUI_CTX_TIMER_COUNT
+#define BUI_CTX_TIMER_COUNT 4
+#endif
+
+_Static_assert(BUI_CTX_TIMER_COUNT >= 1 && BUI_CTX_TIMER_COUNT <= 8, "BUI_CTX_TIMER_COUNT must be in [1, 8]");
+
 #define BUI_VER_MAJOR 0
 #define BUI_VER_MINOR 8
 #define BUI_VER_PATCH 0
@@ -56,6 +87,22 @@ typedef enum {
 
 #define BUI_BUTTON_STATE_IS_PRESSED(state) ((state & 0x02) == 0x02)
 
+typedef uint8_t bui_priority_t;
+
+// Regions of the display marked dirty with a higher priority are sent to the MCU before those with a lower priority.
+#define BUI_PRIORITY_NORMAL ((bui_priority_t) 0x00)
+#define BUI_PRIORITY_HIGH   ((bui_priority_t) 0x01)
+
+typedef uint8_t bui_power_mode_t;
+
+// The power mode of a BUI context determines how the contents of its display are transformed as they are sent to the
+// MCU. The power consumed by the display scales with the number of lit pixels, so the inverted mode is cheaper for
+// mostly white content, and the dimmed mode (in which only every other pixel in a checkerboard pattern can be lit)
+// roughly halves the power consumed by any content.
+#define BUI_POWER_MODE_NORMAL   ((bui_power_mode_t) 0x00)
+#define BUI_POWER_MODE_INVERTED ((bui_power_mode_t) 0x01)
+#define BUI_POWER_MODE_DIMMED   ((bui_power_mode_t) 0x02)
+
 typedef enum {
 	// Associated data: none
 	BUI_EVENT_DISPLAYED = 1,
@@ -69,8 +116,19 @@ typedef enum {
 	BUI_EVENT_BUTTON_CLICKED = 5,
 	// Associated data: bui_event_data_button_held_t
 	BUI_EVENT_BUTTON_HELD = 6,
+	// Associated data: none
+	BUI_EVENT_FRAME_READY = 7,
+	// Associated data: bui_event_data_timer_t
+	BUI_EVENT_TIMER = 8,
 } bui_event_id_t;
 
+typedef uint16_t bui_event_mask_t;
+
+// The mask of BUI events containing only the event with the provided ID (a bui_event_id_t); masks are combined using |
+#define BUI_EVENT_MASK(id) ((bui_event_mask_t) (1 << (id)))
+// The mask of BUI events containing every event
+#define BUI_EVENT_MASK_ALL ((bui_event_mask_t) 0xFFFF)
+
 typedef struct {
 	// The time elapsed since the last event of the same type, or since the BUI context was initialized (whichever was
 	// most recent), in milliseconds; always > 0
@@ -99,19 +157,48 @@ typedef struct {
 	bui_button_id_t button;
 } bui_event_data_button_held_t;
 
+typedef struct {
+	// The index of the timer that expired; in [0, BUI_CTX_TIMER_COUNT)
+	uint8_t timer;
+} bui_event_data_timer_t;
+
 #define BUI_EVENT_DATA_TIME_ELAPSED(event) ((const bui_event_data_time_elapsed_t*) (event)->data)
 #define BUI_EVENT_DATA_BUTTON_PRESSED(event) ((const bui_event_data_button_pressed_t*) (event)->data)
 #define BUI_EVENT_DATA_BUTTON_RELEASED(event) ((const bui_event_data_button_released_t*) (event)->data)
 #define BUI_EVENT_DATA_BUTTON_CLICKED(event) ((const bui_event_data_button_clicked_t*) (event)->data)
 #define BUI_EVENT_DATA_BUTTON_HELD(event) ((const bui_event_data_button_held_t*) (event)->data)
+#define BUI_EVENT_DATA_TIMER(event) ((const bui_event_data_timer_t*) (event)->data)
 
 typedef struct {
 	// The ID of the event
 	bui_event_id_t id;
+	// The time at which the event occurred, according to the clock of the BUI context in which it occurred (see
+	// bui_ctx_get_time(...)), in milliseconds
+	uint32_t time;
 	// A pointer to extra data associated with the event, or NULL if there is no such data
 	const void *data;
 } bui_event_t;
 
+typedef uint8_t bui_input_type_t;
+
+// The MCU has finished processing the last display status sent to it
+#define BUI_INPUT_DISPLAY_PROCESSED ((bui_input_type_t) 0x01)
+// The state of the buttons has changed
+#define BUI_INPUT_BUTTON_PUSH       ((bui_input_type_t) 0x02)
+// Time has elapsed
+#define BUI_INPUT_TICKER            ((bui_input_type_t) 0x03)
+
+// An input event fed to a BUI context, already parsed from whatever transport it was received over (see
+// bui_ctx_input_event(...))
+typedef struct {
+	// The type of the input event; one of BUI_INPUT_DISPLAY_PROCESSED, BUI_INPUT_BUTTON_PUSH, or BUI_INPUT_TICKER
+	bui_input_type_t type;
+	// For BUI_INPUT_BUTTON_PUSH, the mask of the buttons that are now pressed (a combination of BUI_BUTTON_NANOS_LEFT
+	// and BUI_BUTTON_NANOS_RIGHT); for BUI_INPUT_TICKER, the time elapsed in milliseconds, or 0 if it is the ticker
+	// interval of the context; unused for BUI_INPUT_DISPLAY_PROCESSED
+	uint16_t value;
+} bui_input_event_t;
+
 typedef struct bui_ctx_t_ bui_ctx_t;
 
 /*
@@ -125,53 +212,206 @@ typedef struct bui_ctx_t_ bui_ctx_t;
  */
 typedef void (*bui_event_handler_t)(bui_ctx_t *ctx, const bui_event_t *event);
 
+/*
+ * Handle the expiry of a timer in the specified BUI context (see bui_ctx_set_timer(...)). This pointer may be a pointer
+ * to NVRAM determined at link-time, in which case it must be passed through PIC(...) to translate it to a valid address
+ * at runtime.
+ *
+ * Args:
+ *     ctx: the BUI context in which the timer has expired
+ *     timer: the index of the timer; in [0, BUI_CTX_TIMER_COUNT)
+ */
+typedef void (*bui_timer_callback_t)(bui_ctx_t *ctx, uint8_t timer);
+
+/*
+ * Draw an entire frame onto the display of the specified BUI context. In band mode (see BUI_CTX_BAND_ROWS), this is
+ * called once for every band of the frame, and everything drawn outside of the band is clipped. This pointer may be a
+ * pointer to NVRAM determined at link-time, in which case it must be passed through PIC(...) to translate it to a valid
+ * address at runtime.
+ *
+ * Args:
+ *     ctx: the BUI context onto whose display the frame is to be drawn
+ */
+typedef void (*bui_draw_callback_t)(bui_ctx_t *ctx);
+
+/*
+ * The operations through which a BUI context communicates with the MCU (see bui_ctx_init_with_transport(...)). Every
+ * operation is passed the context performing it, so a transport may keep separate state for every context (see
+ * bui_ctx_get_transport_data(...)) and contexts using it may run concurrently on separate threads. These pointers may
+ * be pointers to NVRAM determined at link-time; they are passed through PIC(...) before they are called.
+ */
+typedef struct {
+	/*
+	 * Send a display status to draw a monochrome bitmap onto a region of the display. The MCU is ready to receive a
+	 * status when this is called.
+	 *
+	 * Args:
+	 *     ctx: the BUI context
+	 *     x: the x-coordinate of the region; in [0, 127]
+	 *     y: the y-coordinate of the region; in [0, 31]
+	 *     w: the width of the region; in [1, 128]
+	 *     h: the height of the region; in [1, 32]
+	 *     payload: the bitmap, encoded as in a SEPROXYHAL display status with 1 bit per pixel, where lit pixels are 1
+	 */
+	void (*display)(bui_ctx_t *ctx, uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t *payload);
+	/*
+	 * Send a command to change the interval of the ticker.
+	 *
+	 * Args:
+	 *     ctx: the BUI context
+	 *     interval: the ticker interval, in milliseconds; in [10, 10000]
+	 */
+	void (*set_ticker)(bui_ctx_t *ctx, uint16_t interval);
+	/*
+	 * Send a general status. The MCU is ready to receive a status when this is called.
+	 *
+	 * Args:
+	 *     ctx: the BUI context
+	 */
+	void (*general_status)(bui_ctx_t *ctx);
+} bui_transport_t;
+
+// NOTE: The definition of this struct is considered internal; it may be changed between versions without warning.
+typedef struct {
+	// The x-coordinate of the rectangle; always in [0, 127] if w and h != 0
+	uint8_t x;
+	// The y-coordinate of the rectangle; always in [0, 31] if w and h != 0
+	uint8_t y;
+	// The width of the rectangle; always in [0, 128]
+	uint8_t w;
+	// The height of the rectangle; always in [0, 32]
+	uint8_t h;
+} bui_ctx_rect_t;
+
+// NOTE: The definition of this struct is considered internal; it may be changed between versions without warning.
+typedef struct {
+	// The time (see bui_ctx_t.time) at which the timer next expires
+	uint32_t deadline;
+	// The time between consecutive expiries of the timer, in milliseconds, or 0 if the timer only expires once
+	uint32_t period;
+	// Called when the timer expires, or NULL to dispatch a BUI_EVENT_TIMER event instead
+	bui_timer_callback_t callback;
+} bui_ctx_timer_t;
+
 // NOTE: The definition of this struct is considered internal; it may be changed between versions without warning.
 struct bui_ctx_t_ {
-	// The data for the display buffer bitmap (128x32). This is a 2-dimensional bit array (or "bit block") representing
-	// the contents of the bitmap. The array is encoded as a sequence of bits, starting at the most significant bit,
-	// which is 128 * 32 bits in length, with big-endian byte order. Every 128 bits in the sequence is a row, with 32
-	// rows in total. The values of cells in this array (a bit at a specific row and column) correspond to the color
-	// index of the pixels at their respective location, except the order of rows and columns are both reversed. The
-	// palette of this bitmap is {0xFF000000, 0xFF0000FF}.
-	uint8_t bb[512];
-	// The x-coordinate of the dirty rectangle of this context; always in [0, 127] if dirty_w and dirty_h != 0
-	uint8_t dirty_x;
-	// The y-coordinate of the dirty rectangle of this context; always in [0, 31] if dirty_w and dirty_h != 0
-	uint8_t dirty_y;
-	// The width of the dirty rectangle of this context; always in [0, 128]
-	uint8_t dirty_w;
-	// The height of the dirty rectangle of this context; always in [0, 32]
-	uint8_t dirty_h;
-	// The ticker interval, in milliseconds; always in [10, 10000]
+	// The data for the display buffer bitmap (128xBUI_CTX_BAND_ROWS). This is a 2-dimensional bit array (or "bit
+	// block") representing the contents of the bitmap. The array is encoded as a sequence of bits, starting at the most
+	// significant bit, which is 128 * BUI_CTX_BAND_ROWS bits in length, with big-endian byte order. Every 128 bits in
+	// the sequence is a row. The values of cells in this array (a bit at a specific row and column) correspond to the
+	// color index of the pixels at their respective location, except the order of rows and columns are both reversed.
+	// The palette of this bitmap is {0xFF000000, 0xFF0000FF}. In band mode, the rows of this bitmap are the rows of the
+	// display starting at band_y.
+	uint8_t bb[16 * BUI_CTX_BAND_ROWS];
+#if BUI_CTX_BAND_ROWS != 32
+	// The y-coordinate of the top row of the band held in the display buffer; always a multiple of BUI_CTX_BAND_ROWS
+	// and in [0, 32], where 32 indicates that no frame is being drawn
+	uint8_t band_y;
+	// The number of lit pixels in the bands of the frame being drawn that have been sent to the MCU so far
+	uint16_t lit_accum;
+	// The number of lit pixels in the last frame that was completely sent to the MCU
+	uint16_t lit_count;
+#else
+	// The dirty rectangles of this context, indexed by priority (BUI_PRIORITY_NORMAL or BUI_PRIORITY_HIGH). Each
+	// rectangle encloses all regions of the display buffer drawn to with its priority that haven't yet been sent to the
+	// MCU. A rectangle with a width or height of 0 is empty.
+	bui_ctx_rect_t dirty[2];
+	// The payload of the next display status to be sent, encoded ahead of time (right after the previous display status
+	// was sent) so that it may be sent as soon as the MCU is ready to receive it
+	uint8_t stage[64];
+	// The subrectangle of the display whose contents are encoded in stage; stage doesn't contain a valid payload if the
+	// width of this rectangle is 0. The payload is discarded when any part of this subrectangle is drawn to.
+	bui_ctx_rect_t stage_rect;
+	// The packed full-screen image being drawn onto the display (see bui_ctx_draw_packed_screen(...)), or NULL if there
+	// isn't one. While this is not NULL, the dirty rectangles are empty and the display buffer doesn't yet contain the
+	// image; it is unpacked into the display buffer as soon as anything else is drawn.
+	const uint8_t *packed;
+	// The data for the next tile of the packed image to be sent to the MCU; only valid if packed is not NULL
+	const uint8_t *packed_next;
+	// The index of the next tile of the packed image to be sent to the MCU, in [0, 8], where 8 indicates that the
+	// entire image has been sent; only valid if packed is not NULL
+	uint8_t packed_tile;
+	// The number of lit pixels in each row of the display, indexed by y-coordinate; the counts for rows in the range
+	// [lit_stale_y1, lit_stale_y2) are stale and must be recounted before being used
+	uint8_t lit_rows[32];
+	// The y-coordinate of the first row whose count in lit_rows is stale
+	uint8_t lit_stale_y1;
+	// The y-coordinate just below the last row whose count in lit_rows is stale; no counts are stale if this is equal
+	// to lit_stale_y1
+	uint8_t lit_stale_y2;
+#endif
+	// The time elapsed since this context was initialized according to its ticker events, in milliseconds; wraps
+	// around every 2^32 ms
+	uint32_t time;
+	// The current interval of the MCU's ticker, in milliseconds; always in [10, 10000]
 	uint16_t ticker_interval;
-	// Called whenever a new BUI event occurs (if not NULL)
+	// The ticker interval set using bui_ctx_set_ticker(...), used while anything is animating, in milliseconds; always
+	// in [10, 10000]
+	uint16_t ticker_active_interval;
+	// The ticker interval used while nothing is animating, in milliseconds, or 0 if the ticker isn't adaptive
+	uint16_t ticker_idle_interval;
+	// The shortest time within which the next ticker event has been requested to occur since the last ticker event,
+	// in milliseconds, or 0xFFFF if there have been no requests
+	uint16_t ticker_request;
+	// The timers of this context; only those whose bits are set in timers_active are in use
+	bui_ctx_timer_t timers[BUI_CTX_TIMER_COUNT];
+	// The earliest deadline of the timers in use (see time); undefined if timers_active is 0
+	uint32_t timer_next;
+	// A bit mask of the timers that are in use; the least significant bit corresponds to timers[0]
+	uint8_t timers_active;
+	// Called whenever a new BUI event occurs (if not NULL) whose ID is in event_mask
 	bui_event_handler_t event_handler;
+	// The mask of the BUI events dispatched to event_handler; other events are not dispatched at all
+	bui_event_mask_t event_mask;
+	// The button push and ticker input events that have been queued but not yet processed, from oldest to newest; the
+	// value of every queued ticker event is the (nonzero) total time elapsed, as consecutive ticker events are merged
+	bui_input_event_t queue[BUI_CTX_EVENT_QUEUE_SIZE];
+	// The number of events in queue
+	uint8_t queue_len;
+	// Called to draw every frame (or every band of every frame in band mode) when it begins (if not NULL)
+	bui_draw_callback_t draw_callback;
+	// The transport through which this context communicates with the MCU, or NULL to use SEPROXYHAL directly
+	const bui_transport_t *transport;
+	// The data associated with transport (see bui_ctx_get_transport_data(...))
+	void *transport_data;
+	// The cache of string bitmaps used to draw strings in this context, or NULL if there isn't one (see
+	// bui_font_set_cache(...))
+	struct bui_font_cache_t_ *font_cache;
+	// The time (see time) at which the left button entered its current state (pressed / released)
+	uint32_t button_left_time;
+	// The time (see time) at which the right button entered its current state (pressed / released)
+	uint32_t button_right_time;
 	// True if the left button is currently pressed, false otherwise
 	bool button_left : 1;
-	// The duration, in milliseconds, for which the left button has been in its current state (pressed / released);
-	// maximum of 2^10-1
-	uint16_t button_left_duration : 10;
 	// A representation of the duration for which the left button was in its previous state (pressed / released). 0
 	// indicates it was in the range of [0, BUI_BUTTON_FAST_THRESHOLD) ms, 1 indicates it was in the range of
 	// [BUI_BUTTON_FAST_THRESHOLD, BUI_BUTTON_CLICK_THRESHOLD) ms, and 2 indicates it was greater than or equal to
 	// BUI_BUTTON_CLICK_THRESHOLD ms.
 	uint8_t button_left_prev : 2;
-	// True if the left button is released, and has already triggered a click event because it was released, or false
-	// otherwise
+	// True if the left button is released, and has already triggered a click event because it was released (or can no
+	// longer take part in one), or false otherwise
 	bool button_left_clicked : 1;
 	// True if the right button is currently pressed, false otherwise
 	bool button_right : 1;
-	// The duration, in milliseconds, for which the right button has been in its current state (pressed / released);
-	// maximum of 2^10-1
-	uint16_t button_right_duration : 10;
 	// A representation of the duration for which the right button was in its previous state (pressed / released). 0
 	// indicates it was in the range of [0, BUI_BUTTON_FAST_THRESHOLD) ms, 1 indicates it was in the range of
 	// [BUI_BUTTON_FAST_THRESHOLD, BUI_BUTTON_CLICK_THRESHOLD) ms, and 2 indicates it was greater than or equal to
 	// BUI_BUTTON_CLICK_THRESHOLD ms.
 	uint8_t button_right_prev : 2;
-	// True if the right button is released, and has already triggered a click event because it was released, or false
-	// otherwise
+	// True if the right button is released, and has already triggered a click event because it was released (or can no
+	// longer take part in one), or false otherwise
 	bool button_right_clicked : 1;
+	// True if a display status has been sent to the MCU and the SEPROXYHAL_TAG_DISPLAY_PROCESSED_EVENT acknowledging it
+	// has not yet been received, false otherwise
+	bool display_in_flight : 1;
+	// True if a new frame has been requested using bui_ctx_request_frame(...) but has not yet begun, false otherwise
+	bool frame_requested : 1;
+	// The priority with which regions of the display buffer that are drawn to are marked dirty
+	bui_priority_t draw_priority : 1;
+	// The power mode of this context; one of BUI_POWER_MODE_NORMAL, BUI_POWER_MODE_INVERTED, or BUI_POWER_MODE_DIMMED
+	bui_power_mode_t power_mode : 2;
+	// True if a BUI_INPUT_DISPLAY_PROCESSED event has been queued but not yet processed, false otherwise
+	bool display_processed : 1;
 };
 
 typedef struct {
@@ -577,18 +817,45 @@ void bui_bmp_draw_pixel(bui_bitmap_t bmp, int16_t x, int16_t y, uint32_t color);
 
 /*
  * Initialize / reset a BUI context for the Ledger Nano S. The context's display buffer is initially filled with the
- * background color and the ticker interval is set to 40 ms. The MCU must be ready to receive a command when this
- * function is called.
+ * background color and the ticker interval is set to 40 ms. In band mode (see BUI_CTX_BAND_ROWS), a frame is initially
+ * requested instead. The MCU must be ready to receive a command when this function is called.
  *
  * Args:
  *     ctx: the BUI context to be initialized / reset
  */
 void bui_ctx_init(bui_ctx_t *ctx);
 
+/*
+ * Initialize / reset a BUI context, in the same manner as bui_ctx_init(...), that communicates with the MCU through the
+ * provided transport instead of through SEPROXYHAL. A BUI context that uses a transport never accesses any global state
+ * that is mutable, so any number of them may be used concurrently (for example, to render many screens on a host in
+ * parallel), provided their transports don't share any mutable state. Its events must be fed using
+ * bui_ctx_input_event(...), bui_ctx_queue_input_event(...), or bui_ctx_loop_step_input(...), rather than the functions
+ * that read SEPROXYHAL events from G_io_seproxyhal_spi_buffer.
+ *
+ * Args:
+ *     ctx: the BUI context to be initialized / reset
+ *     transport: the transport; this is passed through PIC(...) and must remain valid for as long as ctx is used
+ *     data: the data to be associated with the transport in ctx, for use by the transport; may be NULL
+ */
+void bui_ctx_init_with_transport(bui_ctx_t *ctx, const bui_transport_t *transport, void *data);
+
+/*
+ * Get the data associated with the transport of the provided BUI context (see bui_ctx_init_with_transport(...)).
+ *
+ * Args:
+ *     ctx: the BUI context
+ * Returns:
+ *     the data, or NULL if the context has no transport or no data was provided
+ */
+void* bui_ctx_get_transport_data(const bui_ctx_t *ctx);
+
 /*
  * Display content waiting within the BUI context's display buffer onto the device's screen by sending a display status
- * over SEPROXYHAL. BUI will attempt to only flush the display buffer when this function is called; however, it may have
- * to do so at other times for reasons including memory constraints on the SE. When the buffer is completely flushed,
+ * over SEPROXYHAL. In band mode (see BUI_CTX_BAND_ROWS), the content waiting to be displayed is the remaining bands of
+ * the frame currently being drawn, the next of which is drawn using the draw callback before being sent. BUI will
+ * attempt to only flush the display buffer when this function is called; however, it may have to do so at other times
+ * for reasons including memory constraints on the SE. When the buffer is completely flushed,
  * bui_ctx_is_displayed(...) will return true and a BUI_EVENT_DISPLAYED event will be dispatched. If this function is
  * called when the display buffer is in the process of being flushed (bui_ctx_is_displayed(...) returns false), then
  * this function has no side effects. When this function is called, the MCU must be ready to receive a status (unless
@@ -602,7 +869,105 @@ void bui_ctx_init(bui_ctx_t *ctx);
 bool bui_ctx_display(bui_ctx_t *ctx);
 
 /*
- * Get the ticker interval in the specified BUI context.
+ * Request that a new frame be drawn in the provided BUI context. The frame is not begun immediately; instead, it is
+ * begun as soon as the previous frame has been fully displayed (every display status containing its data has been
+ * processed by the MCU), at which point a BUI_EVENT_FRAME_READY event is dispatched and the application should draw the
+ * entire frame in response. Any number of requests made before the frame begins are coalesced into that single frame,
+ * so applications may call this function as often as their content changes (eg. on every BUI_EVENT_TIME_ELAPSED)
+ * without drawing intermediate frames that could never be shown.
+ *
+ * Args:
+ *     ctx: the BUI context
+ */
+void bui_ctx_request_frame(bui_ctx_t *ctx);
+
+/*
+ * Determine whether or not a new frame has been requested in the provided BUI context and may be begun right away
+ * (the previous frame has been fully displayed and no display status is awaiting acknowledgement from the MCU).
+ *
+ * Args:
+ *     ctx: the BUI context
+ * Returns:
+ *     true if a requested frame is ready to be drawn, false otherwise
+ */
+bool bui_ctx_is_frame_ready(const bui_ctx_t *ctx);
+
+/*
+ * Set (or unset) the draw callback associated with the given BUI context. If set, the draw callback is invoked to draw
+ * every requested frame as soon as it begins (see bui_ctx_request_frame(...)), after the BUI_EVENT_FRAME_READY event
+ * for the frame has been dispatched. In band mode (see BUI_CTX_BAND_ROWS), a draw callback is required to draw anything
+ * at all; it is invoked once for every band of every frame, just before the band is sent to the MCU, with the band
+ * initially filled with the background color.
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     draw_callback: the draw callback, or NULL to unset the BUI context's draw callback
+ */
+void bui_ctx_set_draw_callback(bui_ctx_t *ctx, bui_draw_callback_t draw_callback);
+
+/*
+ * Set the priority with which regions of the provided BUI context's display that are subsequently drawn to are marked
+ * dirty. When the display buffer is flushed, all regions marked with BUI_PRIORITY_HIGH are sent to the MCU before any
+ * regions marked with BUI_PRIORITY_NORMAL, so latency-critical content (such as a cursor or the feedback for a button
+ * press) can be drawn with a high priority to ensure it becomes visible as soon as possible, regardless of how much
+ * other content has been drawn. The priority of a newly initialized BUI context is BUI_PRIORITY_NORMAL. In band mode
+ * (see BUI_CTX_BAND_ROWS), every band is sent as soon as it is drawn, so the priority has no effect.
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     priority: the priority; either BUI_PRIORITY_NORMAL or BUI_PRIORITY_HIGH
+ */
+void bui_ctx_set_draw_priority(bui_ctx_t *ctx, bui_priority_t priority);
+
+/*
+ * Get the priority with which regions of the provided BUI context's display that are drawn to are marked dirty.
+ *
+ * Args:
+ *     ctx: the BUI context
+ * Returns:
+ *     the priority; either BUI_PRIORITY_NORMAL or BUI_PRIORITY_HIGH
+ */
+bui_priority_t bui_ctx_get_draw_priority(const bui_ctx_t *ctx);
+
+/*
+ * Set the power mode of the provided BUI context. The power mode's transform is applied to the display's contents as
+ * they are encoded to be sent to the MCU, so it doesn't affect the contents of the display buffer or the cost of
+ * drawing. Changing the power mode causes the entire display to be sent to the MCU again (in band mode, a new frame is
+ * requested). The power mode of a newly initialized BUI context is BUI_POWER_MODE_NORMAL.
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     mode: the power mode; one of BUI_POWER_MODE_NORMAL, BUI_POWER_MODE_INVERTED, or BUI_POWER_MODE_DIMMED
+ */
+void bui_ctx_set_power_mode(bui_ctx_t *ctx, bui_power_mode_t mode);
+
+/*
+ * Get the power mode of the provided BUI context.
+ *
+ * Args:
+ *     ctx: the BUI context
+ * Returns:
+ *     the power mode; one of BUI_POWER_MODE_NORMAL, BUI_POWER_MODE_INVERTED, or BUI_POWER_MODE_DIMMED
+ */
+bui_power_mode_t bui_ctx_get_power_mode(const bui_ctx_t *ctx);
+
+/*
+ * Count the number of pixels that are lit on the display of the provided BUI context once its contents are displayed,
+ * taking into account the context's power mode. The count for each row of the display is cached, so only the rows that
+ * have been drawn to since the last call to this function are counted. In band mode (see BUI_CTX_BAND_ROWS), the
+ * bands are counted as they are sent, so this is the number of lit pixels in the last frame that was completely sent
+ * to the MCU.
+ *
+ * Args:
+ *     ctx: the BUI context
+ * Returns:
+ *     the number of lit pixels; in [0, 4096]
+ */
+uint16_t bui_ctx_count_lit_pixels(bui_ctx_t *ctx);
+
+/*
+ * Get the ticker interval in the specified BUI context. If the ticker is adaptive (see bui_ctx_set_idle_ticker(...)),
+ * this is the interval currently in use.
  *
  * Args:
  *     ctx: the BUI context
@@ -612,7 +977,8 @@ bool bui_ctx_display(bui_ctx_t *ctx);
 uint16_t bui_ctx_get_ticker(bui_ctx_t *ctx);
 
 /*
- * Set the specified BUI context's ticker interval.
+ * Set the specified BUI context's ticker interval. If the ticker is adaptive (see bui_ctx_set_idle_ticker(...)), this
+ * is the interval used while anything is animating.
  *
  * Args:
  *     ctx: the BUI context
@@ -620,6 +986,85 @@ uint16_t bui_ctx_get_ticker(bui_ctx_t *ctx);
  */
 void bui_ctx_set_ticker(bui_ctx_t *ctx, uint16_t interval);
 
+/*
+ * Make the specified BUI context's ticker adaptive by setting the interval it slows down to while nothing is animating,
+ * or make it non-adaptive again. While the ticker is adaptive, the interval is chosen after every ticker event: it is
+ * the interval set using bui_ctx_set_ticker(...) if anything requested it using bui_ctx_request_ticker(...) since the
+ * previous ticker event, or else it is as long as possible while still being at most the idle interval and meeting all
+ * other requests (including the context's own detection of held buttons). The interval set using
+ * bui_ctx_set_ticker(...) is also restored immediately whenever a button is pressed or released. The ticker of a newly
+ * initialized BUI context is not adaptive.
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     interval: the idle ticker interval, in milliseconds, which must be in [10, 10000] and should be greater than the
+ *               interval set using bui_ctx_set_ticker(...); or 0 to make the ticker non-adaptive
+ */
+void bui_ctx_set_idle_ticker(bui_ctx_t *ctx, uint16_t interval);
+
+/*
+ * Request that the next ticker event in the specified BUI context occur within the provided amount of time. If the
+ * ticker is adaptive (see bui_ctx_set_idle_ticker(...)), anything animating must request the ticker in this manner
+ * every time it is animated (typically while handling BUI_EVENT_TIME_ELAPSED) for as long as it continues to animate;
+ * otherwise, this function has no effect. Requests take effect after the next ticker event (or button press or
+ * release) at the latest.
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     within: the time within which the next ticker event is needed, in milliseconds; if this is less than the interval
+ *             set using bui_ctx_set_ticker(...) (for example, 0), that interval is requested
+ */
+void bui_ctx_request_ticker(bui_ctx_t *ctx, uint16_t within);
+
+/*
+ * Set one of the timers of the specified BUI context, replacing any previous setting of the same timer. Timers are
+ * checked for expiry after every ticker event, so they expire on the first ticker event at or after their deadline (a
+ * periodic timer expires at most once per ticker event, skipping any periods that were missed). If the ticker is
+ * adaptive (see bui_ctx_set_idle_ticker(...)), it doesn't slow down past the next deadline. When a timer expires, its
+ * callback is called or, if it has none, a BUI_EVENT_TIMER event is dispatched.
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     timer: the index of the timer; must be in [0, BUI_CTX_TIMER_COUNT)
+ *     delay: the time until the timer first expires, in milliseconds; must be less than 2^31
+ *     period: the time between consecutive expiries of the timer, in milliseconds, which must be less than 2^31; or 0
+ *             if the timer is to expire only once
+ *     callback: the function to be called when the timer expires, or NULL to dispatch a BUI_EVENT_TIMER event instead
+ */
+void bui_ctx_set_timer(bui_ctx_t *ctx, uint8_t timer, uint32_t delay, uint32_t period, bui_timer_callback_t callback);
+
+/*
+ * Cancel one of the timers of the specified BUI context, so that it doesn't expire (again). Has no effect if the timer
+ * is not set.
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     timer: the index of the timer; must be in [0, BUI_CTX_TIMER_COUNT)
+ */
+void bui_ctx_cancel_timer(bui_ctx_t *ctx, uint8_t timer);
+
+/*
+ * Determine whether one of the timers of the specified BUI context is set.
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     timer: the index of the timer; must be in [0, BUI_CTX_TIMER_COUNT)
+ * Returns:
+ *     true if the timer is set and has yet to expire (again), false otherwise
+ */
+bool bui_ctx_is_timer_set(const bui_ctx_t *ctx, uint8_t timer);
+
+/*
+ * Get the time remaining until the next deadline of any of the timers of the specified BUI context.
+ *
+ * Args:
+ *     ctx: the BUI context
+ * Returns:
+ *     the time remaining until the next deadline, in milliseconds, 0 if a deadline has already passed (but its timer
+ *     has yet to expire), or 0xFFFFFFFF if no timers are set
+ */
+uint32_t bui_ctx_get_next_timer(const bui_ctx_t *ctx);
+
 /*
  * Set (or unset) the event handler associated with the given BUI context.
  *
@@ -629,9 +1074,33 @@ void bui_ctx_set_ticker(bui_ctx_t *ctx, uint16_t interval);
  */
 void bui_ctx_set_event_handler(bui_ctx_t *ctx, bui_event_handler_t event_handler);
 
+/*
+ * Set the mask of the BUI events that are dispatched to the event handler of the provided BUI context. Events not in
+ * the mask are neither dispatched nor prepared for dispatch, so an application that only declares the events it
+ * actually consumes saves the cost of dispatching the others (most notably BUI_EVENT_TIME_ELAPSED, which occurs every
+ * time the ticker fires). The event mask of a newly initialized BUI context is BUI_EVENT_MASK_ALL.
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     mask: the event mask; a combination of masks created using BUI_EVENT_MASK(...)
+ */
+void bui_ctx_set_event_mask(bui_ctx_t *ctx, bui_event_mask_t mask);
+
+/*
+ * Get the mask of the BUI events that are dispatched to the event handler of the provided BUI context.
+ *
+ * Args:
+ *     ctx: the BUI context
+ * Returns:
+ *     the event mask
+ */
+bui_event_mask_t bui_ctx_get_event_mask(const bui_ctx_t *ctx);
+
 /*
  * Handle a SEPROXYHAL event sent to the SE by the MCU. This function may or may not send commands and / or a status in
- * return.
+ * return. If, after the event has been handled, a requested frame is ready to be drawn (see
+ * bui_ctx_request_frame(...)), the frame is begun and a BUI_EVENT_FRAME_READY event is dispatched; if allow_status is
+ * true, the first display status for the new frame is then sent.
  *
  * Args:
  *     ctx: the BUI context to be notified of the SEPROXYHAL event
@@ -643,6 +1112,98 @@ void bui_ctx_set_event_handler(bui_ctx_t *ctx, bui_event_handler_t event_handler
  */
 bool bui_ctx_seproxyhal_event(bui_ctx_t *ctx, bool allow_status);
 
+/*
+ * Queue a SEPROXYHAL event sent to the SE by the MCU to be handled later by bui_ctx_process_events(...), usually
+ * without dispatching any BUI events. This allows an application that is busy (for example, while computing a long
+ * hash) to acknowledge events quickly and later catch up on all of them at once: consecutive ticker events are merged
+ * into a single BUI_EVENT_TIME_ELAPSED event for the total time elapsed, so that the display is only redrawn once,
+ * while button push events are kept in the order in which they were received. If the queue is full (see
+ * BUI_CTX_EVENT_QUEUE_SIZE), the oldest queued event is handled immediately to make room, which dispatches the BUI
+ * events resulting from it and may send a command to change the interval of the ticker (see bui_ctx_set_ticker(...)).
+ * This function never sends a status to the MCU, so the caller is responsible for responding to the event.
+ *
+ * Args:
+ *     ctx: the BUI context to be notified of the SEPROXYHAL event
+ */
+void bui_ctx_queue_seproxyhal_event(bui_ctx_t *ctx);
+
+/*
+ * Handle all SEPROXYHAL events queued in the provided BUI context using bui_ctx_queue_seproxyhal_event(...), in the
+ * order in which they were received. This may send commands and / or a status to the MCU in the same manner as
+ * bui_ctx_seproxyhal_event(...); in fact, bui_ctx_seproxyhal_event(...) is equivalent to queuing the event and then
+ * calling this function.
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     allow_status: true if a status may be sent to the MCU by this function, false otherwise
+ * Returns:
+ *     true if a status was sent to the MCU, false otherwise
+ */
+bool bui_ctx_process_events(bui_ctx_t *ctx, bool allow_status);
+
+/*
+ * Parse a SEPROXYHAL event sent to the SE by the MCU into an input event for a BUI context.
+ *
+ * Args:
+ *     buff: the buffer containing the SEPROXYHAL event, starting with its tag (for example,
+ *           G_io_seproxyhal_spi_buffer)
+ *     event: the location at which the parsed input event is to be stored
+ * Returns:
+ *     true if the SEPROXYHAL event is of interest to BUI and was parsed into event, false otherwise
+ */
+bool bui_parse_seproxyhal_event(const uint8_t *buff, bui_input_event_t *event);
+
+/*
+ * Queue an input event to be handled later by bui_ctx_process_events(...), in the same manner as
+ * bui_ctx_queue_seproxyhal_event(...). Unlike that function, this doesn't read G_io_seproxyhal_spi_buffer, so it may be
+ * used to feed a context with events from any source (such as bui_ring_drain(...)).
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     event: the input event
+ */
+void bui_ctx_queue_input_event(bui_ctx_t *ctx, const bui_input_event_t *event);
+
+/*
+ * Handle an input event in the provided BUI context, in the same manner as bui_ctx_seproxyhal_event(...); this is
+ * equivalent to queuing the event using bui_ctx_queue_input_event(...) and then calling bui_ctx_process_events(...).
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     event: the input event
+ *     allow_status: true if a status may be sent to the MCU by this function in response to the event, false otherwise
+ * Returns:
+ *     true if a status was sent to the MCU, false otherwise
+ */
+bool bui_ctx_input_event(bui_ctx_t *ctx, const bui_input_event_t *event, bool allow_status);
+
+/*
+ * Handle a SEPROXYHAL event sent to the SE by the MCU and respond to it with exactly one status, making the best use of
+ * that status. The event is first handled as by bui_ctx_seproxyhal_event(...) with a status allowed, so that a
+ * requested frame is drawn at most once, as soon as the previous frame has been displayed (see
+ * bui_ctx_request_frame(...)). If no status was sent as a result, then the status is used to send display data if the
+ * display buffer contains anything not yet displayed and no display status is awaiting acknowledgement, or else a
+ * general status is sent. Applications that use this function for every event they receive never need to call
+ * bui_ctx_display(...) or send a status themselves in response to an event.
+ *
+ * Args:
+ *     ctx: the BUI context to be notified of the SEPROXYHAL event; no status may have been sent in response to the
+ *          event yet
+ */
+void bui_ctx_loop_step(bui_ctx_t *ctx);
+
+/*
+ * Handle an input event and respond to it with exactly one status, in the same manner as bui_ctx_loop_step(...). Unlike
+ * that function, this doesn't read G_io_seproxyhal_spi_buffer, so it may be used by contexts that use a transport (see
+ * bui_ctx_init_with_transport(...)), in which case the general status is sent through the transport.
+ *
+ * Args:
+ *     ctx: the BUI context; no status may have been sent in response to the event yet
+ *     event: the input event, or NULL if the event received is not of interest to BUI (as determined by
+ *            bui_parse_seproxyhal_event(...), for example) but must still be responded to with a status
+ */
+void bui_ctx_loop_step_input(bui_ctx_t *ctx, const bui_input_event_t *event);
+
 /*
  * Determine whether or not the provided BUI context has been fully displayed.
  *
@@ -653,6 +1214,20 @@ bool bui_ctx_seproxyhal_event(bui_ctx_t *ctx, bool allow_status);
  */
 bool bui_ctx_is_displayed(const bui_ctx_t *ctx);
 
+/*
+ * Get the current time according to the monotonic clock of the specified BUI context. The clock starts at 0 when the
+ * context is initialized and is advanced by the time elapsed reported by every ticker event, so it never drifts
+ * relative to the BUI_EVENT_TIME_ELAPSED events dispatched, even if ticker events are merged. Animations may be
+ * computed from this (or from the time of the event being handled) rather than by accumulating elapsed times.
+ *
+ * Args:
+ *     ctx: the BUI context
+ * Returns:
+ *     the time elapsed since ctx was initialized, in milliseconds; wraps around every 2^32 ms, so times should only
+ *     be compared by subtracting them
+ */
+uint32_t bui_ctx_get_time(const bui_ctx_t *ctx);
+
 /*
  * Determine the current state of a button.
  *
@@ -665,7 +1240,8 @@ bool bui_ctx_is_displayed(const bui_ctx_t *ctx);
 bui_button_state_t bui_ctx_get_button(const bui_ctx_t *ctx, bui_button_id_t button);
 
 /*
- * Dispatch an event in the provided BUI context.
+ * Dispatch an event in the provided BUI context. The event is only dispatched if its ID is in the context's event mask
+ * (see bui_ctx_set_event_mask(...)).
  *
  * Args:
  *     ctx: the BUI context
@@ -748,4 +1324,27 @@ void bui_ctx_draw_bitmap(bui_ctx_t *ctx, bui_const_bitmap_t bmp, int16_t src_x,
  */
 void bui_ctx_draw_bitmap_full(bui_ctx_t *ctx, bui_const_bitmap_t bmp, int16_t dest_x, int16_t dest_y);
 
+#if BUI_CTX_BAND_ROWS == 32
+
+/*
+ * Draw a packed (compressed) 128x32 image onto the entire display of the provided BUI context. Rather than being
+ * unpacked into the display buffer, the image is unpacked one tile at a time directly into the payloads of the display
+ * statuses used to send it to the MCU, and it is only unpacked into the display buffer when something is next drawn
+ * onto the display. This makes displaying large static images, such as splash screens, considerably cheaper. This
+ * function is not available in band mode.
+ *
+ * A packed image consists of 8 tiles, each 4 rows tall, ordered from the top of the display to the bottom. Unpacked,
+ * each tile is 64 bytes long and is encoded exactly as the payload of a display status for its rows. Each tile is
+ * packed independently using PackBits run-length encoding: a header byte n in [0x00, 0x7F] is followed by n + 1 bytes
+ * to be copied literally, and a header byte n in [0x81, 0xFF] is followed by a single byte to be repeated 257 - n
+ * times. Packed images may be generated from image files using bitmap.py.
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     packed: the packed image; it must remain valid until something else is drawn onto ctx's display
+ */
+void bui_ctx_draw_packed_screen(bui_ctx_t *ctx, const uint8_t *packed);
+
+#endif
+
 #endif
@@ -110,7 +110,21 @@ int bui_bkb_choose(bui_bkb_bkb_t *bkb, bui_dir_t side);
 bool bui_bkb_animate(bui_bkb_bkb_t *bkb, uint32_t elapsed);
 
 /*
- * Draw the specified keyboard in the specified BUI context.
+ * Request the ticker needed by the keyboard's animations from the specified BUI context (see
+ * bui_ctx_request_ticker(...)), if the keyboard's animations are enabled. While the keys are not animating, the ticker
+ * is only requested for the next time the cursor blinks. If the BUI context's ticker is adaptive, this should be called
+ * every time the keyboard is animated or a choice is made.
+ *
+ * Args:
+ *     bkb: the keyboard
+ *     ctx: the BUI context in which the keyboard is displayed
+ */
+void bui_bkb_request_ticker(const bui_bkb_bkb_t *bkb, bui_ctx_t *ctx);
+
+/*
+ * Draw the specified keyboard in the specified BUI context. The keyboard's textbox (including its cursor) is drawn with
+ * the priority BUI_PRIORITY_HIGH so that typed characters are displayed with minimal latency; the rest of the keyboard
+ * is drawn with the context's current draw priority.
  *
  * Args:
  *     bkb: the keyboard to be drawn
@@ -24,6 +24,7 @@
 #ifndef BUI_FONT_H_
 #define BUI_FONT_H_
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "bui.h"
@@ -49,15 +50,106 @@ extern const bui_font_t bui_font_open_sans_light_32;
 extern const bui_font_t bui_font_open_sans_regular_11;
 extern const bui_font_t bui_font_open_sans_semibold_18;
 
-// NOTE: Despite the font's range, they never include characters in the range 0x80 to 0x9F (both inclusive)
+typedef uint8_t bui_font_flags_t;
+
+// The flags describing how a font's character bitmaps are stored. By default, the bits of every character bitmap are
+// packed into one continuous sequence, so that every row after the first may begin at any bit within a byte. If
+// BUI_FONT_FLAG_ALIGNED_ROWS is set, every row instead begins on a byte boundary and is padded to a whole number of
+// bytes, which costs more space but allows characters to be drawn faster. If BUI_FONT_FLAG_COMPRESSED_ROWS is set,
+// every bitmap begins with one bit for every row (padded to a whole number of bytes), which is set if the row is
+// identical to the previous one (the row before the first being blank), followed by only the rows that are not
+// repeated. In all cases, the bitmaps are stored with both their rows and columns reversed, like the display buffer,
+// and characters with identical bitmaps may share them. See font.py for converting fonts between formats.
+#define BUI_FONT_FLAG_ALIGNED_ROWS    ((bui_font_flags_t) 0x01)
+#define BUI_FONT_FLAG_COMPRESSED_ROWS ((bui_font_flags_t) 0x02)
+
+// NOTE: A font contains bitmaps for a sorted list of ranges of character codes (Unicode code points <= 0xFFFF), which
+// need not be contiguous; the characters in the range 0x80 to 0x9F (both inclusive), for example, are never included.
+// All strings and character buffers accepted by this module are encoded in UTF-8, except that every byte that does not
+// begin a valid UTF-8 sequence is decoded by itself as a Latin-1 character, so Latin-1 text is also accepted. Lengths
+// and indices within strings and character buffers are counted in bytes. Characters with no bitmap in a font are
+// ignored entirely when text is measured or drawn in the font (see bui_font_has_char(...)).
 typedef struct {
 	uint8_t char_height;
 	uint8_t baseline_height;
 	uint8_t char_kerning;
-	uint8_t first_char; // Character code of the first character with a bitmap in this font
-	uint8_t last_char; // Character code of the last character with a bitmap in this font
+	uint16_t first_char; // Character code of the first character with a bitmap in this font
+	uint16_t last_char; // Character code of the last character with a bitmap in this font
+	bui_font_flags_t flags; // The flags describing how the font's bitmaps are stored (see BUI_FONT_FLAG_*)
 } bui_font_info_t;
 
+// A string laid out in a font, storing the x-offset of every character so that the string may be measured, queried,
+// and drawn repeatedly without being measured again (see bui_font_layout_init(...)). The layout refers to the
+// characters and offsets arrays rather than copying them, so they must remain valid (and the characters unchanged) for
+// as long as the layout is used.
+typedef struct {
+	// The font in which the characters are laid out
+	bui_font_t font;
+	// The characters laid out
+	const char *chars;
+	// The x-offset of each character relative to the first, followed by the width of all of the characters as
+	// calculated by bui_font_get_char_buff_width(...) (but without the limit of 1023); there are len + 1 entries, one
+	// for each byte, and the bytes after the first in a multi-byte character have the offset of the next character
+	const int16_t *offsets;
+	// The number of bytes laid out
+	uint8_t len;
+} bui_font_layout_t;
+
+// A line of text produced by bui_font_wrap_text(...)
+typedef struct __attribute__((packed)) {
+	uint16_t start; // The index in the text of the first character in the line
+	uint8_t len; // The number of characters in the line
+} bui_font_line_t;
+
+// A constant string pre-rendered in a particular font when the application is built (using font.py), so that it may be
+// drawn without being measured or rendered (see bui_font_draw_text(...)).
+typedef struct {
+	// The bitmap of the rows of the string's ink bounding box, which is bb_w pixels wide and ink_height pixels tall; it
+	// is encoded like the display buffer of a BUI context (see bui_ctx_t), except that it has only bb_w bits per row.
+	// This is NULL if the string has no ink (ink_height is 0).
+	const uint8_t *bb;
+	// The width of the string as calculated by bui_font_get_str_width(...) (including the kerning after the last
+	// character)
+	int16_t w;
+	// The width of the bitmap, in pixels; this is w less the kerning after the last character, or 0 if the string is
+	// empty
+	int16_t bb_w;
+	// The y-coordinate of the top row of the bitmap, relative to the top of the string's characters
+	uint8_t ink_y;
+	// The height of the bitmap, in pixels
+	uint8_t ink_height;
+	// The baseline height of the string's font
+	uint8_t baseline_height;
+} bui_font_text_t;
+
+// A cache of the bitmaps of strings drawn using bui_font_draw_string(...), stored in an arena provided by the
+// application (see bui_font_cache_init(...)). While a cache is attached to a BUI context (see bui_font_set_cache(...)),
+// every string drawn in the context using bui_font_draw_string(...) is rendered once into a bitmap in the arena, and
+// later draws of the same string in the same font blit the bitmap instead; when the arena is full, the least recently
+// drawn bitmaps are evicted. Strings are identified by their addresses, so strings whose contents change (unlike
+// labels such as string literals) must not be drawn while a cache is attached unless it is cleared whenever they change
+// (see bui_font_cache_clear(...)). The hit and miss counters may be used to choose the size of the arena. Strings that
+// are drawn entirely off-screen are neither cached nor counted, and in band mode (see BUI_CTX_BAND_ROWS), a string is
+// only counted (and cached) in the first band of each frame in which it is visible.
+// NOTE: The fields of this struct other than hits and misses are considered internal; they may be changed between
+// versions without warning.
+typedef struct bui_font_cache_t_ {
+	// The number of strings drawn on-screen using a cached bitmap
+	uint32_t hits;
+	// The number of strings drawn on-screen without a cached bitmap, including those whose bitmaps are too large to be
+	// cached
+	uint32_t misses;
+	// The arena in which the bitmaps are stored, each preceded by a header aligned to the size of a pointer
+	uint8_t *arena;
+	// The usable size of the arena, in bytes
+	uint16_t size;
+	// The number of bytes at the start of the arena occupied by entries
+	uint16_t used;
+	// Incremented every time a string is drawn using this cache, so as to determine which bitmap was drawn least
+	// recently
+	uint32_t clock;
+} bui_font_cache_t;
+
 /*
  * Get the info for a particular font.
  *
@@ -68,14 +160,26 @@ typedef struct {
  */
 const bui_font_info_t* bui_font_get_font_info(bui_font_t font);
 
+/*
+ * Determine whether a particular font has a bitmap for a character. This takes O(log n) time in the number of ranges of
+ * characters in the font.
+ *
+ * Args:
+ *     font: the font
+ *     code: the character code (the Unicode code point)
+ * Returns:
+ *     true if the font has a bitmap for the character, false otherwise
+ */
+bool bui_font_has_char(bui_font_t font, uint16_t code);
+
 /*
  * Get the width of a given character in the specified font.
  *
  * Args:
  *     font: the font
- *     ch: the character code
+ *     ch: the character code, as a Latin-1 character
  * Returns:
- *     the width of the given character, in pixels
+ *     the width of the given character, in pixels, or 0 if the font has no bitmap for it
  */
 uint8_t bui_font_get_char_width(bui_font_t font, char ch);
 
@@ -84,7 +188,7 @@ uint8_t bui_font_get_char_width(bui_font_t font, char ch);
  *
  * Args:
  *     font: the font
- *     str: the string, as a null-terminated string of characters renderable in font
+ *     str: the string, as a null-terminated string
  * Returns:
  *     the width of the given string, in pixels; if the width is greater than 1023, 1023 is returned
  */
@@ -97,18 +201,37 @@ int16_t bui_font_get_str_width(bui_font_t font, const char *str);
 int16_t bui_font_get_char_buff_width(bui_font_t font, const char *char_buff, uint8_t len);
 
 /*
- * Get the pointer to the bitmap for a character in a particular font.
+ * Get the pointer to the bitmap for a character in a particular font. The bitmap contains only the rows of the
+ * character's ink bounding box (see bui_font_get_char_ink(...)) and is one character wide, unless the font has the flag
+ * BUI_FONT_FLAG_ALIGNED_ROWS, in which case it is as wide as the character rounded up to a multiple of 8, with the
+ * character aligned to the right and padded on the left. If the font has the flag BUI_FONT_FLAG_COMPRESSED_ROWS, the
+ * bitmap is compressed as described for that flag.
  *
  * Args:
  *     font: the font
- *     ch: the character code
+ *     ch: the character code, as a Latin-1 character
  *     w_dest: a pointer to an int in which the width of the character will be stored; if this is NULL, it is not
  *             accessed
  * Returns:
- *     the pointer to the bitmap for the specified character in the specified font
+ *     the pointer to the bitmap for the specified character in the specified font, or NULL if the font has no bitmap
+ *     for the character
  */
 const uint8_t* bui_font_get_char_bitmap(bui_font_t font, char ch, int16_t *w_dest);
 
+/*
+ * Get the ink bounding box of a character in a particular font, which is the smallest range of rows of the character
+ * that contains all of its lit pixels. Only these rows are stored in the character's bitmap.
+ *
+ * Args:
+ *     font: the font
+ *     ch: the character code, as a Latin-1 character
+ *     y_dest: a pointer to an int in which the y-coordinate of the top row of the bounding box, relative to the top of
+ *             the character, will be stored
+ *     h_dest: a pointer to an int in which the height of the bounding box will be stored; this is 0 if the character
+ *             has no lit pixels
+ */
+void bui_font_get_char_ink(bui_font_t font, char ch, uint8_t *y_dest, uint8_t *h_dest);
+
 /*
  * Draw a character in the specified font in the specified BUI context. Any part of the character out of bounds of the
  * display will not be drawn. The coordinates provided determine the position of the text anchor. The actual bounds the
@@ -119,7 +242,7 @@ const uint8_t* bui_font_get_char_bitmap(bui_font_t font, char ch, int16_t *w_des
  *
  * Args:
  *     ctx: the BUI context in which the character is to be drawn
- *     ch: the character code of the character to be drawn
+ *     ch: the character code of the character to be drawn, as a Latin-1 character
  *     x: the x-coordinate of the text anchor; must be >= -32,768 and <= 32,767
  *     y: the y-coordinate of the text anchor; must be >= -32,768 and <= 32,767
  *     alignment: the position of the anchor within the text boundaries
@@ -142,9 +265,24 @@ void bui_font_draw_char(bui_ctx_t *ctx, char ch, int16_t x, int16_t y, bui_dir_t
  *     y: the y-coordinate of the text anchor; must be >= -32,768 and <= 32,767
  *     alignment: the position of the anchor within the text boundaries
  *     font: the font to be used to render the string
+ * Note that if a string bitmap cache is attached to the context (see bui_font_set_cache(...)), the string's bitmap is
+ * drawn from the cache.
  */
 void bui_font_draw_string(bui_ctx_t *ctx, const char *str, int16_t x, int16_t y, bui_dir_t alignment, bui_font_t font);
 
+/*
+ * Draw a pre-rendered string in the specified BUI context, exactly as bui_font_draw_string(...) would draw the string
+ * in its font, but by blitting its bitmap without measuring it or rendering any characters.
+ *
+ * Args:
+ *     ctx: the BUI context in which the string is to be drawn
+ *     text: the pre-rendered string, as generated by font.py
+ *     x: the x-coordinate of the text anchor; must be >= -32,768 and <= 32,767
+ *     y: the y-coordinate of the text anchor; must be >= -32,768 and <= 32,767
+ *     alignment: the position of the anchor within the text boundaries
+ */
+void bui_font_draw_text(bui_ctx_t *ctx, const bui_font_text_t *text, int16_t x, int16_t y, bui_dir_t alignment);
+
 /*
  * This is a convenience function very similar to bui_font_draw_string(...), except instead of accepting a
  * null-terminated string as an argument, this function accepts a character buffer and its length.
@@ -152,4 +290,120 @@ void bui_font_draw_string(bui_ctx_t *ctx, const char *str, int16_t x, int16_t y,
 void bui_font_draw_char_buff(bui_ctx_t *ctx, const char *char_buff, uint8_t len, int16_t x, int16_t y,
 		bui_dir_t alignment, bui_font_t font);
 
+/*
+ * Lay out a character buffer in the specified font by calculating the x-offset of every character once.
+ *
+ * Args:
+ *     layout: the layout to be initialized
+ *     font: the font
+ *     char_buff: the characters to be laid out; the layout refers to this buffer, rather than copying it
+ *     len: the number of bytes in char_buff
+ *     offsets: an array of at least len + 1 entries in which the offsets are to be stored; the layout refers to this
+ *              array, rather than copying it
+ */
+void bui_font_layout_init(bui_font_layout_t *layout, bui_font_t font, const char *char_buff, uint8_t len,
+		int16_t *offsets);
+
+/*
+ * Get the width of the first characters of a layout, as would be calculated by bui_font_get_char_buff_width(...)
+ * (including the kerning after the last character, but without the limit of 1023).
+ *
+ * Args:
+ *     layout: the layout
+ *     n: the number of characters at the start of the layout to be measured; must be <= layout->len
+ * Returns:
+ *     the width of the first n characters, in pixels
+ */
+int16_t bui_font_layout_get_width(const bui_font_layout_t *layout, uint8_t n);
+
+/*
+ * Determine how many characters at the start of a layout fit within a given width, as when truncating (or ellipsizing)
+ * text to fit a region of the display. The characters fit if they can be drawn within the width, not counting the
+ * kerning after the last one. This takes O(log n) time.
+ *
+ * Args:
+ *     layout: the layout
+ *     w: the width available, in pixels
+ * Returns:
+ *     the greatest number of characters at the start of the layout that fit within w; in [0, layout->len]
+ */
+uint8_t bui_font_layout_fit(const bui_font_layout_t *layout, int16_t w);
+
+/*
+ * Determine which character of a layout is at a given x-offset from its left edge, where each character is considered
+ * to extend across the kerning after it. This takes O(log n) time.
+ *
+ * Args:
+ *     layout: the layout
+ *     x: the x-offset relative to the left edge of the first character, in pixels
+ * Returns:
+ *     the index of the character at x, or -1 if there is none
+ */
+int16_t bui_font_layout_hit(const bui_font_layout_t *layout, int16_t x);
+
+/*
+ * Draw the first characters of a layout in the specified BUI context, in the same manner as
+ * bui_font_draw_char_buff(...) but without measuring them again.
+ *
+ * Args:
+ *     ctx: the BUI context in which the characters are to be drawn
+ *     layout: the layout
+ *     n: the number of characters at the start of the layout to be drawn; must be <= layout->len
+ *     x: the x-coordinate of the text anchor; must be >= -32,768 and <= 32,767
+ *     y: the y-coordinate of the text anchor; must be >= -32,768 and <= 32,767
+ *     alignment: the position of the anchor within the text boundaries
+ */
+void bui_font_layout_draw(bui_ctx_t *ctx, const bui_font_layout_t *layout, uint8_t n, int16_t x, int16_t y,
+		bui_dir_t alignment);
+
+/*
+ * Break a null-terminated string into lines no wider than a specified width in a particular font. The string is broken
+ * at every '\n' character and wherever else a line would otherwise be too wide, preferably at a space; the spaces at
+ * which lines are wrapped are omitted from both lines, and spaces at the start of a line that would otherwise be
+ * wrapped at one of them (leaving it empty) are omitted entirely. A word that is too wide to fit on a line by itself is
+ * broken at the last character that fits. The lines produced may be stored (for example, in a room's stack frame) and
+ * drawn repeatedly using bui_font_draw_char_buff(...) without measuring the string again.
+ *
+ * Args:
+ *     font: the font
+ *     str: the string; must have < 65,536 characters
+ *     w: the maximum width of each line, in pixels; every line contains at least one character (unless it is empty in
+ *        str), even if it is wider than this
+ *     lines: the array in which the first max_lines lines are to be stored, in order; may be NULL if max_lines is 0
+ *     max_lines: the maximum number of lines to be stored in lines
+ * Returns:
+ *     the total number of lines in the string, or 255 if there are more than 255
+ */
+uint8_t bui_font_wrap_text(bui_font_t font, const char *str, int16_t w, bui_font_line_t *lines, uint8_t max_lines);
+
+/*
+ * Initialize a string bitmap cache, which is empty and has both of its counters set to 0.
+ *
+ * Args:
+ *     cache: the cache to be initialized
+ *     arena: the memory in which bitmaps are to be cached; the cache refers to this memory for as long as it is used
+ *     size: the size of arena in bytes; each cached string takes up a header of 16 bytes (on the Nano S) plus
+ *           ceil(w * h / 8) bytes, where w is the width of the string and h is the height of its font
+ */
+void bui_font_cache_init(bui_font_cache_t *cache, void *arena, uint16_t size);
+
+/*
+ * Evict every bitmap from a string bitmap cache, as must be done whenever the contents of a cached string change. The
+ * cache's counters are not reset.
+ *
+ * Args:
+ *     cache: the cache
+ */
+void bui_font_cache_clear(bui_font_cache_t *cache);
+
+/*
+ * Attach a string bitmap cache to a BUI context, to be used by bui_font_draw_string(...) in that context. A cache
+ * should only be attached to one context at a time.
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     cache: the cache, or NULL to detach the context's cache (if any)
+ */
+void bui_font_set_cache(bui_ctx_t *ctx, bui_font_cache_t *cache);
+
 #endif
@@ -126,6 +126,17 @@ bool bui_menu_scroll(bui_menu_menu_t *menu, bool dir);
  */
 bool bui_menu_animate(bui_menu_menu_t *menu, uint32_t elapsed);
 
+/*
+ * Request the ticker needed by the menu's animations from the specified BUI context (see bui_ctx_request_ticker(...)),
+ * if the menu is currently animating. If the BUI context's ticker is adaptive, this should be called every time the
+ * menu is animated or scrolled.
+ *
+ * Args:
+ *     menu: the menu
+ *     ctx: the BUI context in which the menu is displayed
+ */
+void bui_menu_request_ticker(const bui_menu_menu_t *menu, bui_ctx_t *ctx);
+
 /*
  * Draw the menu in the specified BUI context.
  *
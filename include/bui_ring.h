@@ -0,0 +1,112 @@
+/*
+ * License for the BOLOS User Interface Library project, originally found here:
+ * https://github.com/parkerhoyes/bolos-user-interface
+ *
+ * Copyright (C) 2016, 2017 Parker Hoyes <contact@parkerhoyes.com>
+ *
+ * This software is provided "as-is", without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the
+ * use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not claim
+ *    that you wrote the original software. If you use this software in a
+ *    product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#ifndef BUI_RING_H_
+#define BUI_RING_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bui.h"
+
+/*
+ * The BUI Ring Module implements a single-producer / single-consumer lock-free ring buffer of input events, intended
+ * for host builds of BUI (such as simulators) in which input events are received on one thread (for example, an I/O
+ * thread) and handled by a BUI context on another (the UI thread). The producer pushes events onto the ring as they are
+ * received, and the consumer periodically drains them into the context in a batch (using bui_ring_drain(...)) before
+ * processing them all at once (using bui_ctx_process_events(...)). Apart from initialization, each function in this
+ * module must only be called by either the producer or the consumer, as documented; no locking is required otherwise.
+ *
+ * This module requires C11 atomics, so it is unavailable if the compiler doesn't support them.
+ */
+
+#ifndef __STDC_NO_ATOMICS__
+
+#include <stdatomic.h>
+
+// The maximum number of input events in a ring at once
+#ifndef BUI_RING_SIZE
+#define BUI_RING_SIZE 16
+#endif
+
+_Static_assert(BUI_RING_SIZE >= 1 && BUI_RING_SIZE <= 128 && (BUI_RING_SIZE & (BUI_RING_SIZE - 1)) == 0,
+		"BUI_RING_SIZE must be a power of 2 in [1, 128]");
+
+// NOTE: The definition of this struct is considered internal; it may be changed between versions without warning.
+typedef struct {
+	// The events in the ring; the event with index i (counting from the first event ever pushed) is stored at
+	// events[i % BUI_RING_SIZE]
+	bui_input_event_t events[BUI_RING_SIZE];
+	// The index of the oldest event in the ring, modulo 256; only written by the consumer
+	_Atomic uint8_t head;
+	// The index just after the newest event in the ring, modulo 256; only written by the producer
+	_Atomic uint8_t tail;
+} bui_ring_t;
+
+/*
+ * Initialize an empty ring. This must be done before the ring is shared between the producer and the consumer.
+ *
+ * Args:
+ *     ring: the ring
+ */
+void bui_ring_init(bui_ring_t *ring);
+
+/*
+ * Push an input event onto a ring. This must only be called by the producer.
+ *
+ * Args:
+ *     ring: the ring
+ *     event: the input event
+ * Returns:
+ *     true if the event was pushed, false if the ring is full
+ */
+bool bui_ring_push(bui_ring_t *ring, const bui_input_event_t *event);
+
+/*
+ * Pop the oldest input event off of a ring. This must only be called by the consumer.
+ *
+ * Args:
+ *     ring: the ring
+ *     event: the location at which the input event is to be stored
+ * Returns:
+ *     true if an event was popped, false if the ring is empty
+ */
+bool bui_ring_pop(bui_ring_t *ring, bui_input_event_t *event);
+
+/*
+ * Pop every input event in a ring at the time of the call and queue them in a BUI context using
+ * bui_ctx_queue_input_event(...), so that they may then be processed as a batch using bui_ctx_process_events(...).
+ * Events pushed by the producer while this function is executing are left in the ring. This must only be called by the
+ * consumer.
+ *
+ * Args:
+ *     ring: the ring
+ *     ctx: the BUI context
+ * Returns:
+ *     the number of events drained; in [0, BUI_RING_SIZE]
+ */
+uint8_t bui_ring_drain(bui_ring_t *ring, bui_ctx_t *ctx);
+
+#endif
+
+#endif
@@ -124,12 +124,17 @@ typedef void (*bui_room_event_handler_t)(bui_room_ctx_t *ctx, const bui_room_eve
 typedef struct {
 	// The event handler used to dispatch an event to this room.
 	bui_room_event_handler_t event_handler;
+	// The mask of the BUI events that are not forwarded to this room by bui_room_forward_event(...). This is 0 by
+	// default, meaning that all events are forwarded.
+	bui_event_mask_t ignored_events;
 } bui_room_t;
 
 /*
  * Initialize a room context with the specified preallocated stack and base room. The room's enter callback is called.
  * The new stack frame (which is initially empty) is guaranteed to start at a memory address aligned to a 4-byte
- * boundary (ctx->stack_ptr % 4 is 0); this is achieved by adding padding before the stack frame, if necessary.
+ * boundary (ctx->stack_ptr % 4 is 0); this is achieved by adding padding before the stack frame, if necessary. The base
+ * room isn't drawn until a frame is requested using bui_ctx_request_frame(...), so the application must request one
+ * after calling this function.
  *
  * Args:
  *     ctx: the room context
@@ -147,7 +152,9 @@ void bui_room_ctx_init(bui_room_ctx_t *ctx, void *stack, const bui_room_t *room,
  * callback is called and the new room's enter callback is called. The provided pointer to the new room is passed
  * through PIC(...) before being pushed onto the stack. The new stack frame (which is initially empty) is guaranteed to
  * start at a memory address aligned to a 4-byte boundary (ctx->stack_ptr % 4 is 0); this is achieved by adding padding
- * between this stack frame and the previous one, if necessary.
+ * between this stack frame and the previous one, if necessary. bui_room_handle_bui_event(...) requests a frame if the
+ * event it handles causes a room to be entered; if this function is called in any other context, the application must
+ * request a frame using bui_ctx_request_frame(...) afterwards so that the new room is drawn.
  *
  * Args:
  *     ctx: the room context
@@ -163,7 +170,9 @@ void bui_room_enter(bui_room_ctx_t *ctx, const bui_room_t *room, const void *arg
 /*
  * Exit the current room, popping its stack frame off of the stack. The current room's exit callback is called and the
  * new room's enter callback is called. All data left in the current stack frame is returned to the room with the stack
- * frame directly below the current one (it is pushed onto that room's stack frame).
+ * frame directly below the current one (it is pushed onto that room's stack frame). As with bui_room_enter(...), a
+ * frame must be requested afterwards unless this function is called while bui_room_handle_bui_event(...) handles an
+ * event.
  *
  * Args:
  *     ctx: the room context
@@ -255,7 +264,8 @@ void bui_room_dispatch_event(bui_room_ctx_t *ctx, const bui_room_event_t *event)
 
 /*
  * Forward a BUI event (of type bui_event_t, NOT bui_room_event_t) to the current room in the specified room context by
- * dispatching a room event with ID BUI_ROOM_EVENT_FORWARD.
+ * dispatching a room event with ID BUI_ROOM_EVENT_FORWARD. If the event is in the current room's ignored events, this
+ * function has no effect.
  *
  * Args:
  *     ctx: the room context
@@ -263,6 +273,23 @@ void bui_room_dispatch_event(bui_room_ctx_t *ctx, const bui_room_event_t *event)
  */
 void bui_room_forward_event(bui_room_ctx_t *ctx, const bui_event_t *bui_event);
 
+/*
+ * Handle a BUI event on behalf of the specified room context; this is intended to be called for every event from the
+ * event handler of the BUI context, in combination with bui_ctx_loop_step(...). When a requested frame is ready to be
+ * drawn (BUI_EVENT_FRAME_READY), the display is cleared and a BUI_ROOM_EVENT_DRAW event is dispatched to the current
+ * room so that it is drawn exactly once per frame; every other event is forwarded to the current room as by
+ * bui_room_forward_event(...). Rooms should call bui_ctx_request_frame(...) whenever their appearance changes rather
+ * than drawing immediately; if handling the event enters or exits a room, a new frame is requested automatically. In
+ * band mode (see BUI_CTX_BAND_ROWS), the current room must instead be drawn by the draw callback of the BUI context,
+ * since every frame is drawn one band at a time.
+ *
+ * Args:
+ *     ctx: the room context
+ *     bui_ctx: the BUI context in which the event occurred
+ *     bui_event: the BUI event
+ */
+void bui_room_handle_bui_event(bui_room_ctx_t *ctx, bui_ctx_t *bui_ctx, const bui_event_t *bui_event);
+
 /*
  * A "built-in" implementation of a BUI room that displays a custom message (in a custom font) on the screen until the
  * user acknowledges the message.
@@ -274,8 +301,11 @@ extern const bui_room_t bui_room_message;
 
 typedef struct {
 	// The message to be displayed on screen, as a null-terminated string. All characters must be renderable in font
-	// (except '\n' characters may also be included). Must have <= 255 lines (must have < 255 '\n' characters). Each
-	// line must have <= 255 characters.
+	// (except '\n' characters may also be included). Lines too wide for the display are wrapped (see
+	// bui_font_wrap_text(...)) when the room is entered, and the message must not be modified while the room is in use.
+	// Must have <= 255 lines after wrapping. The lines are stored on the room context stack after these arguments for
+	// as long as the room is in use, taking up 1 + 3 * n bytes (where n is the number of lines), so the stack must have
+	// at least that many bytes free beyond these arguments.
 	const char *msg;
 	// The font in which to render msg.
 	bui_font_t font;
@@ -292,8 +322,11 @@ extern const bui_room_t bui_room_confirm;
 
 typedef struct {
 	// The message to be displayed on screen, as a null-terminated string. All characters must be renderable in font
-	// (except '\n' characters may also be included). Must have <= 255 lines (must have < 255 '\n' characters). Each
-	// line must have <= 255 characters.
+	// (except '\n' characters may also be included). Lines too wide for the display are wrapped (see
+	// bui_font_wrap_text(...)) when the room is entered, and the message must not be modified while the room is in use.
+	// Must have <= 255 lines after wrapping. The lines are stored on the room context stack after these arguments for
+	// as long as the room is in use, taking up 1 + 3 * n bytes (where n is the number of lines), so the stack must have
+	// at least that many bytes free beyond these arguments.
 	const char *msg;
 	// The font in which to render msg.
 	bui_font_t font;
@@ -30,6 +30,7 @@
 #include "os_io_seproxyhal.h"
 
 #include "bui_bitmaps.inc"
+#include "bui_internal.h"
 
 // The duration, in milliseconds, longer than which a button must be held for it to not be considered a "click" anymore
 #ifndef BUI_BUTTON_LONG_THRESHOLD
@@ -42,317 +43,642 @@
 
 #define BUI_ABS_DIST(a, b) ((a) > (b) ? (a) - (b) : (b) - (a))
 
+static const uint32_t bui_ctx_palette[] = {
+	BUI_CLR_BLACK,
+	BUI_CLR_WHITE,
+};
+
+#if BUI_CTX_BAND_ROWS == 32
+// A sequence of alternating bits long enough to be blitted over an entire row of the display starting from either of
+// its first two bits
+static const uint8_t bui_dim_pattern[17] = {
+	0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA,
+};
+#endif
+
 /*
- * Perform a bitwise Boolean operation between a source squence of bits and a destination sequence of bits, storing the
- * result in the destination sequence of bits. The source and destination sequences may not be overlapping. No bytes
- * that do not contain bits in either of the source or destination sequences are accessed.
+ * Reverse the bytes in a byte buffer.
  *
  * Args:
- *     src: the pointer to the byte containing the first bit in the source sequence
- *     src_o: the index of the first bit in the source sequence in its byte (0 for the most significant bit, 7 for the
- *            least); must be <= 7
- *     dest: the pointer to the byte containing the first bit in the destination sequence
- *     dest_o: the index of the first bit in the destination sequence in its byte (0 for the most significant bit, 7 for
- *             the least); must be <= 7
- *     n: the number of bits in each of the source and destination sequences
+ *     buffer: the byte buffer
+ *     size: the number of bytes to be reversed
  */
-typedef void (*bui_bitblit_func_t)(const uint8_t *src, uint8_t src_o, uint8_t *dest, uint8_t dest_o, uint32_t n);
+static inline void bui_reverse_bytes(uint8_t *buffer, uint32_t size) {
+	// Integer underflow on j is anticipated and acceptable
+	for (uint32_t i = 0, j = size - 1; i < size / 2; i++, j--) {
+		uint8_t temp = buffer[i];
+		buffer[i] = buffer[j];
+		buffer[j] = temp;
+	}
+}
 
-static const uint32_t bui_ctx_palette[] = {
-	BUI_CLR_BLACK,
-	BUI_CLR_WHITE,
-};
+/*
+ * Count the number of bits that are set in a 32-bit word.
+ *
+ * Args:
+ *     word: the word
+ * Returns:
+ *     the number of bits in word that are set
+ */
+static inline uint8_t bui_popcount(uint32_t word) {
+	word = word - ((word >> 1) & 0x55555555);
+	word = (word & 0x33333333) + ((word >> 2) & 0x33333333);
+	word = (word + (word >> 4)) & 0x0F0F0F0F;
+	return (word * 0x01010101) >> 24;
+}
 
 /*
- * An implementation of bui_bitblit_func_t that performs dest = src.
+ * Apply the provided BUI context's power mode transform to a sequence of entire rows of the display, encoded either as
+ * they are in the display buffer or as they are for transport (the transform is the same for both).
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     rows: the rows, 16 bytes per row
+ *     n: the number of rows
+ *     y: the y-coordinate of the first row in rows
  */
-static inline void bui_bitblit_set(const uint8_t *src, uint8_t src_o, uint8_t *dest, uint8_t dest_o, uint32_t n) {
-	while (true) {
-		if (n >= 8) {
-			uint8_t bits = src[0] << src_o;
-			if (src_o != 0)
-				bits |= src[1] >> (8 - src_o);
-			dest[0] &= ~(0xFF >> dest_o);
-			dest[0] |= bits >> dest_o;
-			if (dest_o != 0) {
-				dest[1] &= 0xFF >> dest_o;
-				dest[1] |= bits << (8 - dest_o);
-			}
-			src++;
-			dest++;
-			n -= 8;
-		} else if (n == 0) {
-			break;
-		} else { // n is in [1, 7]
-			uint8_t bits = src[0] << src_o;
-			if (8 - src_o < n)
-				bits |= src[1] >> (8 - src_o);
-			bits &= ~(0xFF >> n);
-			uint8_t mask = ~(0xFF >> n);
-			dest[0] &= ~(mask >> dest_o);
-			dest[0] |= bits >> dest_o;
-			if (8 - dest_o < n) {
-				dest[1] &= ~(mask << (8 - dest_o));
-				dest[1] |= bits << (8 - dest_o);
-			}
-			break;
-		}
+static inline void bui_ctx_transform_rows(const bui_ctx_t *ctx, uint8_t *rows, uint8_t n, uint8_t y) {
+	for (uint16_t i = 0; i < 16 * (uint16_t) n; i++) {
+		if (ctx->power_mode == BUI_POWER_MODE_INVERTED)
+			rows[i] = ~rows[i];
+		else if (ctx->power_mode == BUI_POWER_MODE_DIMMED)
+			rows[i] &= (y + i / 16) % 2 == 0 ? 0x55 : 0xAA;
 	}
 }
 
 /*
- * An implementation of bui_bitblit_func_t that performs dest = ~src.
+ * Send a display status containing the provided payload to the MCU through the transport of the provided BUI context.
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     x: the x-coordinate of the region to be drawn
+ *     y: the y-coordinate of the region to be drawn
+ *     w: the width of the region to be drawn
+ *     h: the height of the region to be drawn
+ *     payload: the payload, encoded for transport
  */
-static inline void bui_bitblit_not_set(const uint8_t *src, uint8_t src_o, uint8_t *dest, uint8_t dest_o, uint32_t n) {
-	while (true) {
-		if (n >= 8) {
-			uint8_t bits = src[0] << src_o;
-			if (src_o != 0)
-				bits |= src[1] >> (8 - src_o);
-			bits = ~bits;
-			dest[0] &= ~(0xFF >> dest_o);
-			dest[0] |= bits >> dest_o;
-			if (dest_o != 0) {
-				dest[1] &= 0xFF >> dest_o;
-				dest[1] |= bits << (8 - dest_o);
-			}
-			src++;
-			dest++;
-			n -= 8;
-		} else if (n == 0) {
-			break;
-		} else { // n is in [1, 7]
-			uint8_t bits = src[0] << src_o;
-			if (8 - src_o < n)
-				bits |= src[1] >> (8 - src_o);
-			bits &= ~(0xFF >> n);
-			bits = ~bits;
-			uint8_t mask = ~(0xFF >> n);
-			dest[0] &= ~(mask >> dest_o);
-			dest[0] |= bits >> dest_o;
-			if (8 - dest_o < n) {
-				dest[1] &= ~(mask << (8 - dest_o));
-				dest[1] |= bits << (8 - dest_o);
-			}
-			break;
-		}
+static void bui_ctx_send_display(bui_ctx_t *ctx, uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t *payload) {
+	if (ctx->transport != NULL) {
+		((void (*)(bui_ctx_t*, uint8_t, uint8_t, uint8_t, uint8_t, const uint8_t*)) PIC(ctx->transport->display))(
+				ctx, x, y, w, h, payload);
+		return;
 	}
+	uint32_t palette[] = {0x00000000, 0x00FFFFFF};
+	io_seproxyhal_display_bitmap(x, y, w, h, palette, 1, payload);
 }
 
+#if BUI_CTX_BAND_ROWS == 32
+
 /*
- * An implementation of bui_bitblit_func_t that performs dest = dest | src.
+ * Mark the lit pixel counts of a range of rows of the provided BUI context's display as stale.
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     y1: the y-coordinate of the first row in the range
+ *     y2: the y-coordinate just below the last row in the range; must be > y1
  */
-static inline void bui_bitblit_or(const uint8_t *src, uint8_t src_o, uint8_t *dest, uint8_t dest_o, uint32_t n) {
-	while (true) {
-		if (n >= 8) {
-			uint8_t bits = src[0] << src_o;
-			if (src_o != 0)
-				bits |= src[1] >> (8 - src_o);
-			dest[0] |= bits >> dest_o;
-			if (dest_o != 0) {
-				dest[1] |= bits << (8 - dest_o);
-			}
-			src++;
-			dest++;
-			n -= 8;
-		} else if (n == 0) {
-			break;
-		} else { // n is in [1, 7]
-			uint8_t bits = src[0] << src_o;
-			if (8 - src_o < n)
-				bits |= src[1] >> (8 - src_o);
-			bits &= ~(0xFF >> n);
-			dest[0] |= bits >> dest_o;
-			if (8 - dest_o < n) {
-				dest[1] |= bits << (8 - dest_o);
-			}
-			break;
-		}
+static inline void bui_ctx_stale_lit(bui_ctx_t *ctx, uint8_t y1, uint8_t y2) {
+	if (ctx->lit_stale_y1 == ctx->lit_stale_y2) {
+		ctx->lit_stale_y1 = y1;
+		ctx->lit_stale_y2 = y2;
+		return;
 	}
+	if (y1 < ctx->lit_stale_y1)
+		ctx->lit_stale_y1 = y1;
+	if (y2 > ctx->lit_stale_y2)
+		ctx->lit_stale_y2 = y2;
 }
 
 /*
- * An implementation of bui_bitblit_func_t that performs dest = dest & src.
+ * Count the number of pixels in a row of the provided BUI context's display buffer that are lit once the context's
+ * power mode transform is applied.
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     y: the y-coordinate of the row; must be in [0, 31]
+ * Returns:
+ *     the number of lit pixels in the row; in [0, 128]
  */
-static inline void bui_bitblit_and(const uint8_t *src, uint8_t src_o, uint8_t *dest, uint8_t dest_o, uint32_t n) {
-	while (true) {
-		if (n >= 8) {
-			uint8_t bits = src[0] << src_o;
-			if (src_o != 0)
-				bits |= src[1] >> (8 - src_o);
-			dest[0] &= bits >> dest_o;
-			if (dest_o != 0) {
-				dest[1] &= bits << (8 - dest_o);
-			}
-			src++;
-			dest++;
-			n -= 8;
-		} else if (n == 0) {
-			break;
-		} else { // n is in [1, 7]
-			uint8_t bits = src[0] << src_o;
-			if (8 - src_o < n)
-				bits |= src[1] >> (8 - src_o);
-			bits &= ~(0xFF >> n);
-			dest[0] &= bits >> dest_o;
-			if (8 - dest_o < n) {
-				dest[1] &= bits << (8 - dest_o);
-			}
-			break;
-		}
+static inline uint8_t bui_ctx_count_lit_row(const bui_ctx_t *ctx, uint8_t y) {
+	const uint8_t *row = &ctx->bb[16 * (31 - y)];
+	uint32_t inv = ctx->power_mode == BUI_POWER_MODE_INVERTED ? 0xFFFFFFFF : 0x00000000;
+	uint32_t mask = 0xFFFFFFFF;
+	if (ctx->power_mode == BUI_POWER_MODE_DIMMED)
+		mask = y % 2 == 0 ? 0x55555555 : 0xAAAAAAAA;
+	uint8_t count = 0;
+	for (uint8_t i = 0; i < 16; i += 4) {
+		uint32_t word = ((uint32_t) row[i] << 24) | ((uint32_t) row[i + 1] << 16) | ((uint32_t) row[i + 2] << 8)
+				| (uint32_t) row[i + 3];
+		count += bui_popcount((word ^ inv) & mask);
 	}
+	return count;
 }
 
 /*
- * An implementation of bui_bitblit_func_t that performs dest = dest | ~src.
+ * Determine the next subrectangle of the provided BUI context's display to be sent to the MCU. The subrectangle is
+ * taken from the top or left edge of the highest-priority dirty rectangle that is not empty, and is as large as
+ * possible while still fitting in a single display status. There must be additional data within the display buffer
+ * ready to be sent (bui_ctx_is_displayed(ctx) must be false).
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     sub: the pointer to the rectangle in which to store the subrectangle
+ * Returns:
+ *     the pointer to the dirty rectangle from which the subrectangle was taken
  */
-static inline void bui_bitblit_or_not(const uint8_t *src, uint8_t src_o, uint8_t *dest, uint8_t dest_o, uint32_t n) {
-	while (true) {
-		if (n >= 8) {
-			uint8_t bits = src[0] << src_o;
-			if (src_o != 0)
-				bits |= src[1] >> (8 - src_o);
-			dest[0] |= ~(bits >> dest_o);
-			if (dest_o != 0) {
-				dest[1] |= ~(bits << (8 - dest_o));
-			}
-			src++;
-			dest++;
-			n -= 8;
-		} else if (n == 0) {
-			break;
-		} else { // n is in [1, 7]
-			uint8_t bits = src[0] << src_o;
-			if (8 - src_o < n)
-				bits |= src[1] >> (8 - src_o);
-			bits &= ~(0xFF >> n);
-			dest[0] |= ~(bits >> dest_o);
-			if (8 - dest_o < n) {
-				dest[1] |= ~(bits << (8 - dest_o));
-			}
-			break;
-		}
+static inline bui_ctx_rect_t* bui_ctx_next_sub(bui_ctx_t *ctx, bui_ctx_rect_t *sub) {
+	bui_ctx_rect_t *dirty = &ctx->dirty[BUI_PRIORITY_HIGH];
+	if (dirty->w == 0 || dirty->h == 0)
+		dirty = &ctx->dirty[BUI_PRIORITY_NORMAL];
+	*sub = *dirty;
+	// Constrain the bounds of the subrectangle such that it fits in 64 bytes (512 pixels)
+	if ((uint16_t) sub->w * sub->h > 512) {
+		if (sub->w > sub->h)
+			sub->w = 512 / sub->h;
+		else
+			sub->h = 512 / sub->w;
 	}
+	return dirty;
 }
 
 /*
- * An implementation of bui_bitblit_func_t that performs dest = dest & ~src.
+ * Encode a subrectangle of the provided BUI context's display buffer for transport in a display status, applying the
+ * context's power mode transform.
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     sub: the subrectangle to be encoded; its area must be <= 512
+ *     dest: the buffer in which to store the encoded subrectangle; must be at least (sub.w * sub.h + 7) / 8 bytes long
  */
-static inline void bui_bitblit_and_not(const uint8_t *src, uint8_t src_o, uint8_t *dest, uint8_t dest_o, uint32_t n) {
-	while (true) {
-		if (n >= 8) {
-			uint8_t bits = src[0] << src_o;
-			if (src_o != 0)
-				bits |= src[1] >> (8 - src_o);
-			dest[0] &= ~(bits >> dest_o);
-			if (dest_o != 0) {
-				dest[1] &= ~(bits << (8 - dest_o));
-			}
-			src++;
-			dest++;
-			n -= 8;
-		} else if (n == 0) {
-			break;
-		} else { // n is in [1, 7]
-			uint8_t bits = src[0] << src_o;
-			if (8 - src_o < n)
-				bits |= src[1] >> (8 - src_o);
-			bits &= ~(0xFF >> n);
-			dest[0] &= ~(bits >> dest_o);
-			if (8 - dest_o < n) {
-				dest[1] &= ~(bits << (8 - dest_o));
-			}
-			break;
+static inline void bui_ctx_encode(const bui_ctx_t *ctx, bui_ctx_rect_t sub, uint8_t *dest) {
+	uint16_t size = ((uint16_t) sub.w * sub.h + 7) / 8;
+	os_memset(dest, 0, size);
+	uint8_t xr = 128 - sub.x - sub.w;
+	uint8_t yr = 32 - sub.y - sub.h;
+	for (uint8_t i = 0; i < sub.h; i++) {
+		uint16_t src_i = 128 * (yr + i) + xr;
+		uint16_t dest_i = sub.w * i;
+		bui_bitblit_or(&ctx->bb[src_i / 8], src_i % 8, &dest[dest_i / 8], dest_i % 8, sub.w);
+		// Only leave pixels lit whose coordinates sum to an even number by clearing the others; the rows and the
+		// columns within them are in reverse order
+		if (ctx->power_mode == BUI_POWER_MODE_DIMMED)
+			bui_bitblit_and_not(bui_dim_pattern, (sub.x + sub.w + sub.y + sub.h - i + 1) % 2, &dest[dest_i / 8],
+					dest_i % 8, sub.w);
+	}
+	if (ctx->power_mode == BUI_POWER_MODE_INVERTED) {
+		for (uint16_t i = 0; i < size; i++)
+			dest[i] = ~dest[i];
+	}
+	bui_reverse_bytes(dest, size);
+}
+
+/*
+ * Unpack a single tile of a packed full-screen image (see bui_ctx_draw_packed_screen(...)).
+ *
+ * Args:
+ *     src: the packed data for the tile
+ *     dest: the buffer in which to store the unpacked tile; must be at least 64 bytes long
+ * Returns:
+ *     the pointer to the packed data for the next tile
+ */
+static const uint8_t* bui_unpack_tile(const uint8_t *src, uint8_t *dest) {
+	for (uint8_t i = 0; i < 64;) {
+		uint8_t n = *src++;
+		if (n < 0x80) {
+			os_memcpy(&dest[i], src, n + 1);
+			src += n + 1;
+			i += n + 1;
+		} else {
+			os_memset(&dest[i], *src++, 257 - n);
+			i += 257 - n;
 		}
 	}
+	return src;
 }
 
 /*
- * Reverse the bytes in a byte buffer.
+ * Unpack the packed full-screen image being drawn onto the provided BUI context's display (if there is one) into the
+ * display buffer, and mark the tiles of the image that haven't yet been sent to the MCU as dirty.
  *
  * Args:
- *     buffer: the byte buffer
- *     size: the number of bytes to be reversed
+ *     ctx: the BUI context
  */
-static inline void bui_reverse_bytes(uint8_t *buffer, uint32_t size) {
-	// Integer underflow on j is anticipated and acceptable
-	for (uint32_t i = 0, j = size - 1; i < size / 2; i++, j--) {
-		uint8_t temp = buffer[i];
-		buffer[i] = buffer[j];
-		buffer[j] = temp;
+static void bui_ctx_unpack_screen(bui_ctx_t *ctx) {
+	if (ctx->packed == NULL)
+		return;
+	// The rows of the display buffer are reversed, so the tiles are stored from the end of the display buffer to the
+	// start, each with its bytes reversed
+	const uint8_t *src = ctx->packed;
+	for (uint8_t i = 0; i < 8; i++) {
+		uint8_t *tile = &ctx->bb[448 - 64 * i];
+		src = bui_unpack_tile(src, tile);
+		bui_reverse_bytes(tile, 64);
 	}
+	bui_ctx_stale_lit(ctx, 0, 32);
+	if (ctx->packed_tile != 8) {
+		uint8_t y = ctx->packed_tile * 4;
+		ctx->dirty[BUI_PRIORITY_NORMAL] = (bui_ctx_rect_t) { .x = 0, .y = y, .w = 128, .h = 32 - y };
+	}
+	ctx->packed = NULL;
 }
 
 /*
  * Send some data contained within the provided BUI context's display buffer to the MCU to be displayed. The data is
- * sent using a display status, and as such the MCU must be ready to receive a status when calling this function. There
- * must be additional data within the display buffer ready to be sent (bui_ctx_is_displayed(ctx) must be false).
+ * taken from the packed full-screen image being drawn, if there is one, or else from the highest-priority dirty
+ * rectangle that is not empty. The data is sent using a display status, and as such the MCU must be ready to receive a
+ * status when calling this function. There must be additional data within the display buffer ready to be sent
+ * (bui_ctx_is_displayed(ctx) must be false). After the status is sent, the payload of the next display status (if there
+ * is one) is encoded ahead of time.
  *
  * Args:
  *     ctx: the BUI context
  */
 static inline void bui_ctx_send_display_status(bui_ctx_t *ctx) {
-	uint8_t sub_w = ctx->dirty_w;
-	uint8_t sub_h = ctx->dirty_h;
-	// Constrain the bounds of the subrectangle of the dirty rectangle such that it fits in 64 bytes
-	uint16_t size;
-	if (sub_w > sub_h) {
-		while ((size = ((uint16_t) sub_w * sub_h + 7) / 8) > 64)
-			sub_w -= 1;
-	} else {
-		while ((size = ((uint16_t) sub_w * sub_h + 7) / 8) > 64)
-			sub_h -= 1;
-	}
-	// Encode the subrectangle for transport
-	uint8_t sub[64];
-	os_memset(sub, 0, size);
-	uint8_t xr = 128 - ctx->dirty_x - sub_w;
-	uint8_t yr = 32 - ctx->dirty_y - sub_h;
-	for (uint8_t i = 0; i < sub_h; i++) {
-		uint16_t src_i = 128 * (yr + i) + xr;
-		uint16_t dest_i = sub_w * i;
-		bui_bitblit_or(&ctx->bb[src_i / 8], src_i % 8, &sub[dest_i / 8], dest_i % 8, sub_w);
+	// Send the next tile of the packed full-screen image, if there is one, unpacking it directly into the payload
+	if (ctx->packed != NULL) {
+		ctx->packed_next = bui_unpack_tile(ctx->packed_next, ctx->stage);
+		bui_ctx_transform_rows(ctx, ctx->stage, 4, ctx->packed_tile * 4);
+		bui_ctx_send_display(ctx, 0, ctx->packed_tile * 4, 128, 4, ctx->stage);
+		ctx->display_in_flight = true;
+		ctx->packed_tile += 1;
+		return;
 	}
-	bui_reverse_bytes(sub, size);
+	bui_ctx_rect_t sub;
+	bui_ctx_rect_t *dirty = bui_ctx_next_sub(ctx, &sub);
+	// Encode the subrectangle for transport, unless it has already been staged
+	if (ctx->stage_rect.x != sub.x || ctx->stage_rect.y != sub.y || ctx->stage_rect.w != sub.w
+			|| ctx->stage_rect.h != sub.h)
+		bui_ctx_encode(ctx, sub, ctx->stage);
 	// Display the subrectangle
-	uint32_t palette[] = {0x00000000, 0x00FFFFFF};
-	io_seproxyhal_display_bitmap(ctx->dirty_x, ctx->dirty_y, sub_w, sub_h, palette, 1, sub);
+	bui_ctx_send_display(ctx, sub.x, sub.y, sub.w, sub.h, ctx->stage);
+	ctx->display_in_flight = true;
 	// Exclude subrectangle from the dirty rectangle
-	if (sub_w != ctx->dirty_w) {
-		ctx->dirty_x += sub_w;
-		ctx->dirty_w -= sub_w;
+	if (sub.w != dirty->w) {
+		dirty->x += sub.w;
+		dirty->w -= sub.w;
+	} else {
+		dirty->y += sub.h;
+		dirty->h -= sub.h;
+	}
+	// Stage the next subrectangle while the MCU is processing this one
+	if (bui_ctx_is_displayed(ctx)) {
+		ctx->stage_rect.w = 0;
 	} else {
-		ctx->dirty_y += sub_h;
-		ctx->dirty_h -= sub_h;
+		bui_ctx_next_sub(ctx, &ctx->stage_rect);
+		bui_ctx_encode(ctx, ctx->stage_rect, ctx->stage);
 	}
 }
 
+#else
+
 /*
- * Extend the provided BUI context's dirty rectangle by the minimum amount such that it encloses the provided rectangle.
- * The provided rectangle must be entirely within the display's coordinate plane.
+ * Draw the next band of the frame being drawn in the provided BUI context using the context's draw callback, and send
+ * it to the MCU to be displayed. The band is sent using a display status, and as such the MCU must be ready to receive
+ * a status when calling this function. There must be a frame being drawn (bui_ctx_is_displayed(ctx) must be false).
  *
  * Args:
  *     ctx: the BUI context
- *     x: the x-coordinate of the top-left corner of the rectangle
- *     y: the y-coordinate of the top-left corner of the rectangle
- *     w: the width of the rectangle; must be != 0
- *     h: the height of the rectangle; must be != 0
  */
-static inline void bui_ctx_dirty(bui_ctx_t *ctx, uint8_t x, uint8_t y, uint8_t w, uint8_t h) {
+static inline void bui_ctx_send_display_status(bui_ctx_t *ctx) {
+	// Draw the band
+	os_memset(ctx->bb, 0, sizeof(ctx->bb));
+	if (ctx->draw_callback != NULL)
+		ctx->draw_callback(ctx);
+	// The band spans the entire width of the display, so it is encoded for transport simply by reversing its bytes
+	bui_reverse_bytes(ctx->bb, sizeof(ctx->bb));
+	bui_ctx_transform_rows(ctx, ctx->bb, BUI_CTX_BAND_ROWS, ctx->band_y);
+	// Count the band's lit pixels
+	if (ctx->band_y == 0)
+		ctx->lit_accum = 0;
+	for (uint8_t i = 0; i < sizeof(ctx->bb); i += 4) {
+		ctx->lit_accum += bui_popcount(((uint32_t) ctx->bb[i] << 24) | ((uint32_t) ctx->bb[i + 1] << 16)
+				| ((uint32_t) ctx->bb[i + 2] << 8) | (uint32_t) ctx->bb[i + 3]);
+	}
+	if (ctx->band_y + BUI_CTX_BAND_ROWS == 32)
+		ctx->lit_count = ctx->lit_accum;
+	// Display the band
+	bui_ctx_send_display(ctx, 0, ctx->band_y, 128, BUI_CTX_BAND_ROWS, ctx->bb);
+	ctx->display_in_flight = true;
+	ctx->band_y += BUI_CTX_BAND_ROWS;
+}
+
+#endif
+
+void bui_ctx_dirty(bui_ctx_t *ctx, uint8_t x, uint8_t y, uint8_t w, uint8_t h) {
+#if BUI_CTX_BAND_ROWS == 32
+	// The display buffer must contain the packed full-screen image before anything else can be drawn over it
+	bui_ctx_unpack_screen(ctx);
+	bui_ctx_stale_lit(ctx, y, y + h);
+	// Discard the staged display status if the region it contains is being drawn to
+	bui_ctx_rect_t *stage = &ctx->stage_rect;
+	if (x < stage->x + stage->w && stage->x < x + w && y < stage->y + stage->h && stage->y < y + h)
+		stage->w = 0;
+	bui_ctx_rect_t *dirty = &ctx->dirty[ctx->draw_priority];
+	if (dirty->w == 0 || dirty->h == 0) {
+		// The dirty rectangle is empty, so its position is meaningless and must not be enclosed
+		dirty->x = x;
+		dirty->y = y;
+		dirty->w = w;
+		dirty->h = h;
+		return;
+	}
 	uint8_t x2 = x + w;
 	uint8_t y2 = y + h;
-	uint8_t dx2 = ctx->dirty_x + ctx->dirty_w;
-	uint8_t dy2 = ctx->dirty_y + ctx->dirty_h;
-	if (x < ctx->dirty_x)
-		ctx->dirty_x = x;
-	if (y < ctx->dirty_y)
-		ctx->dirty_y = y;
+	uint8_t dx2 = dirty->x + dirty->w;
+	uint8_t dy2 = dirty->y + dirty->h;
+	if (x < dirty->x)
+		dirty->x = x;
+	if (y < dirty->y)
+		dirty->y = y;
 	if (dx2 < x2)
 		dx2 = x2;
 	if (dy2 < y2)
 		dy2 = y2;
-	ctx->dirty_w = dx2 - ctx->dirty_x;
-	ctx->dirty_h = dy2 - ctx->dirty_y;
+	dirty->w = dx2 - dirty->x;
+	dirty->h = dy2 - dirty->y;
+#endif
+}
+
+/*
+ * Send a command to the MCU to change the interval of its ticker, and record the new interval in the provided BUI
+ * context.
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     interval: the ticker interval, in milliseconds; must be in [10, 10000]
+ */
+static void bui_ctx_send_ticker(bui_ctx_t *ctx, uint16_t interval) {
+	ctx->ticker_interval = interval;
+	if (ctx->transport != NULL) {
+		((void (*)(bui_ctx_t*, uint16_t)) PIC(ctx->transport->set_ticker))(ctx, interval);
+		return;
+	}
+	// Set the ticker interval to interval ms
+	uint8_t buff[5];
+	buff[0] = SEPROXYHAL_TAG_SET_TICKER_INTERVAL;
+	buff[1] = 0; // Message length, high byte
+	buff[2] = 2; // Message length, low byte
+	buff[3] = (interval >> 8) & 0xFF; // Ticker interval, high byte
+	buff[4] = interval & 0xFF; // Ticker interval, low byte
+	io_seproxyhal_spi_send(buff, 5);
+}
+
+/*
+ * Choose the interval of the provided BUI context's ticker until the next ticker event based on the requests made
+ * since the previous one, if the ticker is adaptive.
+ *
+ * Args:
+ *     ctx: the BUI context
+ */
+static void bui_ctx_adapt_ticker(bui_ctx_t *ctx) {
+	if (ctx->ticker_idle_interval == 0)
+		return;
+	uint16_t interval = ctx->ticker_idle_interval;
+	if (ctx->ticker_request < interval)
+		interval = ctx->ticker_request;
+	ctx->ticker_request = 0xFFFF;
+	// Buttons that are pressed must be timed until they are held
+	uint32_t left = ctx->time - ctx->button_left_time;
+	if (ctx->button_left && left < BUI_BUTTON_LONG_THRESHOLD && BUI_BUTTON_LONG_THRESHOLD - left < interval)
+		interval = BUI_BUTTON_LONG_THRESHOLD - left;
+	uint32_t right = ctx->time - ctx->button_right_time;
+	if (ctx->button_right && right < BUI_BUTTON_LONG_THRESHOLD && BUI_BUTTON_LONG_THRESHOLD - right < interval)
+		interval = BUI_BUTTON_LONG_THRESHOLD - right;
+	// The ticker must not sleep past the next deadline of any timer
+	uint32_t timer = bui_ctx_get_next_timer(ctx);
+	if (timer < interval)
+		interval = timer;
+	if (interval < ctx->ticker_active_interval)
+		interval = ctx->ticker_active_interval;
+	if (interval != ctx->ticker_interval)
+		bui_ctx_send_ticker(ctx, interval);
+}
+
+/*
+ * Find the earliest deadline of the timers in use in the provided BUI context.
+ *
+ * Args:
+ *     ctx: the BUI context
+ */
+static void bui_ctx_update_next_timer(bui_ctx_t *ctx) {
+	uint32_t next = 0xFFFFFFFF; // The shortest time remaining until a deadline
+	for (uint8_t i = 0; i < BUI_CTX_TIMER_COUNT; i++) {
+		if ((ctx->timers_active & (1 << i)) == 0)
+			continue;
+		// A deadline that has already passed (but whose timer hasn't yet expired) has no time remaining
+		uint32_t remaining = ctx->timers[i].deadline - ctx->time;
+		if ((int32_t) remaining <= 0)
+			remaining = 0;
+		if (remaining < next)
+			next = remaining;
+	}
+	ctx->timer_next = ctx->time + next;
+}
+
+/*
+ * Expire the timers in the provided BUI context whose deadlines have passed, calling their callbacks or dispatching
+ * BUI_EVENT_TIMER events.
+ *
+ * Args:
+ *     ctx: the BUI context
+ */
+static void bui_ctx_expire_timers(bui_ctx_t *ctx) {
+	if (ctx->timers_active == 0 || (int32_t) (ctx->timer_next - ctx->time) > 0)
+		return;
+	uint8_t due = 0;
+	for (uint8_t i = 0; i < BUI_CTX_TIMER_COUNT; i++) {
+		if ((ctx->timers_active & (1 << i)) != 0 && (int32_t) (ctx->timers[i].deadline - ctx->time) <= 0)
+			due |= 1 << i;
+	}
+	for (uint8_t i = 0; i < BUI_CTX_TIMER_COUNT; i++) {
+		bui_ctx_timer_t *timer = &ctx->timers[i];
+		// The timer may have been changed by the callback of a previous timer
+		if ((due & (1 << i)) == 0 || (ctx->timers_active & (1 << i)) == 0
+				|| (int32_t) (timer->deadline - ctx->time) > 0)
+			continue;
+		if (timer->period == 0)
+			ctx->timers_active &= ~(1 << i);
+		else
+			timer->deadline += ((ctx->time - timer->deadline) / timer->period + 1) * timer->period;
+		if (timer->callback != NULL) {
+			timer->callback(ctx, i);
+		} else {
+			bui_event_data_timer_t data = { .timer = i };
+			bui_event_t event = { .id = BUI_EVENT_TIMER, .time = ctx->time, .data = &data };
+			bui_ctx_dispatch_event(ctx, &event);
+		}
+	}
+	bui_ctx_update_next_timer(ctx);
+}
+
+/*
+ * Handle a change in the state of the buttons of the provided BUI context, dispatching any resulting BUI events.
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     button_mask: the mask of the buttons that are currently pressed; a combination of BUI_BUTTON_NANOS_LEFT and
+ *                  BUI_BUTTON_NANOS_RIGHT
+ */
+static void bui_ctx_buttons(bui_ctx_t *ctx, unsigned int button_mask) {
+	uint8_t left = 0, right = 0; // 0 = no change, 1 = pressed, 2 = released, 3 = clicked
+	if ((button_mask & BUI_BUTTON_NANOS_LEFT) != 0) {
+		if (!ctx->button_left) {
+			left = 1;
+			uint32_t prev = ctx->time - ctx->button_left_time;
+			ctx->button_left = true;
+			ctx->button_left_time = ctx->time;
+			ctx->button_left_prev = prev < BUI_BUTTON_FAST_THRESHOLD ? 0 :
+					(prev < BUI_BUTTON_LONG_THRESHOLD ? 1 : 2);
+			ctx->button_left_clicked = false;
+		}
+	} else {
+		if (ctx->button_left) {
+			uint32_t prev = ctx->time - ctx->button_left_time;
+			left = prev < BUI_BUTTON_LONG_THRESHOLD ? 3 : 2;
+			ctx->button_left = false;
+			ctx->button_left_time = ctx->time;
+			ctx->button_left_prev = prev < BUI_BUTTON_FAST_THRESHOLD ? 0 :
+					(prev < BUI_BUTTON_LONG_THRESHOLD ? 1 : 2);
+		}
+	}
+	if ((button_mask & BUI_BUTTON_NANOS_RIGHT) != 0) {
+		if (!ctx->button_right) {
+			right = 1;
+			uint32_t prev = ctx->time - ctx->button_right_time;
+			ctx->button_right = true;
+			ctx->button_right_time = ctx->time;
+			ctx->button_right_prev = prev < BUI_BUTTON_FAST_THRESHOLD ? 0 :
+					(prev < BUI_BUTTON_LONG_THRESHOLD ? 1 : 2);
+			ctx->button_right_clicked = false;
+		}
+	} else {
+		if (ctx->button_right) {
+			uint32_t prev = ctx->time - ctx->button_right_time;
+			right = prev < BUI_BUTTON_LONG_THRESHOLD ? 3 : 2;
+			ctx->button_right = false;
+			ctx->button_right_time = ctx->time;
+			ctx->button_right_prev = prev < BUI_BUTTON_FAST_THRESHOLD ? 0 :
+					(prev < BUI_BUTTON_LONG_THRESHOLD ? 1 : 2);
+		}
+	}
+	// Restore the active ticker interval, since the buttons need to be timed and anything may start animating
+	if ((left != 0 || right != 0) && ctx->ticker_idle_interval != 0
+			&& ctx->ticker_interval != ctx->ticker_active_interval)
+		bui_ctx_send_ticker(ctx, ctx->ticker_active_interval);
+	switch (left) {
+	case 1: {
+		bui_event_data_button_pressed_t data = { .button = BUI_BUTTON_NANOS_LEFT };
+		bui_event_t event = { .id = BUI_EVENT_BUTTON_PRESSED, .time = ctx->time, .data = &data };
+		bui_ctx_dispatch_event(ctx, &event);
+	} break;
+	case 2: {
+		bui_event_data_button_released_t data = { .button = BUI_BUTTON_NANOS_LEFT,
+				.prev_state = BUI_BUTTON_STATE_HELD };
+		bui_event_t event = { .id = BUI_EVENT_BUTTON_RELEASED, .time = ctx->time, .data = &data };
+		bui_ctx_dispatch_event(ctx, &event);
+	} break;
+	case 3: {
+		bui_event_data_button_released_t data = { .button = BUI_BUTTON_NANOS_LEFT,
+				.prev_state = BUI_BUTTON_STATE_PRESSED };
+		bui_event_t event = { .id = BUI_EVENT_BUTTON_RELEASED, .time = ctx->time, .data = &data };
+		bui_ctx_dispatch_event(ctx, &event);
+	} break;
+	}
+	switch (right) {
+	case 1: {
+		bui_event_data_button_pressed_t data = { .button = BUI_BUTTON_NANOS_RIGHT };
+		bui_event_t event = { .id = BUI_EVENT_BUTTON_PRESSED, .time = ctx->time, .data = &data };
+		bui_ctx_dispatch_event(ctx, &event);
+	} break;
+	case 2: {
+		bui_event_data_button_released_t data = { .button = BUI_BUTTON_NANOS_RIGHT,
+				.prev_state = BUI_BUTTON_STATE_HELD };
+		bui_event_t event = { .id = BUI_EVENT_BUTTON_RELEASED, .time = ctx->time, .data = &data };
+		bui_ctx_dispatch_event(ctx, &event);
+	} break;
+	case 3: {
+		bui_event_data_button_released_t data = { .button = BUI_BUTTON_NANOS_RIGHT,
+				.prev_state = BUI_BUTTON_STATE_PRESSED };
+		bui_event_t event = { .id = BUI_EVENT_BUTTON_RELEASED, .time = ctx->time, .data = &data };
+		bui_ctx_dispatch_event(ctx, &event);
+	} break;
+	}
+	// Dispatch a button clicked event as soon as a short press ends with both buttons released, since a chord can no
+	// longer form; a button released earlier (while the other was still pressed) joins the click as a chord
+	if ((left == 3 || right == 3) && !ctx->button_left && !ctx->button_right) {
+		bui_button_id_t button = BUI_BUTTON_NANOS_NONE;
+		if (!ctx->button_left_clicked && ctx->button_left_prev < 2
+				&& (left == 3 || ctx->time - ctx->button_left_time < BUI_BUTTON_LONG_THRESHOLD))
+			button |= BUI_BUTTON_NANOS_LEFT;
+		if (!ctx->button_right_clicked && ctx->button_right_prev < 2
+				&& (right == 3 || ctx->time - ctx->button_right_time < BUI_BUTTON_LONG_THRESHOLD))
+			button |= BUI_BUTTON_NANOS_RIGHT;
+		ctx->button_left_clicked = true;
+		ctx->button_right_clicked = true;
+		if (button != BUI_BUTTON_NANOS_NONE) {
+			bui_event_data_button_clicked_t data = { .button = button };
+			bui_event_t event = { .id = BUI_EVENT_BUTTON_CLICKED, .time = ctx->time, .data = &data };
+			bui_ctx_dispatch_event(ctx, &event);
+		}
+	}
+}
+
+/*
+ * Elapse time in the provided BUI context, dispatching a BUI_EVENT_TIME_ELAPSED event and any other resulting BUI
+ * events.
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     elapsed: the time elapsed, in milliseconds; must be > 0
+ */
+static void bui_ctx_elapse(bui_ctx_t *ctx, uint32_t elapsed) {
+	uint32_t left_prev = ctx->time - ctx->button_left_time;
+	uint32_t right_prev = ctx->time - ctx->button_right_time;
+	ctx->time += elapsed;
+	bool left_held = ctx->button_left && left_prev < BUI_BUTTON_LONG_THRESHOLD
+			&& left_prev + elapsed >= BUI_BUTTON_LONG_THRESHOLD;
+	bool right_held = ctx->button_right && right_prev < BUI_BUTTON_LONG_THRESHOLD
+			&& right_prev + elapsed >= BUI_BUTTON_LONG_THRESHOLD;
+	// Timers are expired first, so that handlers of the events below always see them up to date
+	bui_ctx_expire_timers(ctx);
+	// Dispatch button held events, if applicable
+	if (left_held || right_held) {
+		bui_event_data_button_held_t data;
+		bui_event_t event = { .id = BUI_EVENT_BUTTON_HELD, .time = ctx->time, .data = &data };
+		if (left_held) {
+			data.button = BUI_BUTTON_NANOS_LEFT;
+			bui_ctx_dispatch_event(ctx, &event);
+		}
+		if (right_held) {
+			data.button = BUI_BUTTON_NANOS_RIGHT;
+			bui_ctx_dispatch_event(ctx, &event);
+		}
+	}
+	// Dispatch time elapsed event, if anything is interested in it
+	if ((ctx->event_mask & BUI_EVENT_MASK(BUI_EVENT_TIME_ELAPSED)) != 0) {
+		bui_event_data_time_elapsed_t data = { .elapsed = elapsed };
+		bui_event_t event = { .id = BUI_EVENT_TIME_ELAPSED, .time = ctx->time, .data = &data };
+		bui_ctx_dispatch_event(ctx, &event);
+	}
+	bui_ctx_adapt_ticker(ctx);
+}
+
+/*
+ * Remove the oldest SEPROXYHAL event from the provided BUI context's event queue and process it. The queue must not be
+ * empty.
+ *
+ * Args:
+ *     ctx: the BUI context
+ */
+static void bui_ctx_process_queued(bui_ctx_t *ctx) {
+	// The event is removed from the queue before being processed, since event handlers may queue more events
+	bui_input_event_t queued = ctx->queue[0];
+	ctx->queue_len -= 1;
+	os_memmove(&ctx->queue[0], &ctx->queue[1], ctx->queue_len * sizeof(ctx->queue[0]));
+	if (queued.type == BUI_INPUT_BUTTON_PUSH)
+		bui_ctx_buttons(ctx, queued.value);
+	else
+		bui_ctx_elapse(ctx, queued.value);
 }
 
 int16_t bui_palette_find(const uint32_t *palette, uint16_t size, uint32_t color) {
@@ -463,24 +789,53 @@ void bui_bmp_draw_pixel(bui_bitmap_t bmp, int16_t x, int16_t y, uint32_t color)
 }
 
 void bui_ctx_init(bui_ctx_t *ctx) {
+	bui_ctx_init_with_transport(ctx, NULL, NULL);
+}
+
+void bui_ctx_init_with_transport(bui_ctx_t *ctx, const bui_transport_t *transport, void *data) {
+	ctx->transport = transport != NULL ? (const bui_transport_t*) PIC(transport) : NULL;
+	ctx->transport_data = data;
 	os_memset(ctx->bb, 0, sizeof(ctx->bb));
-	ctx->dirty_x = 0;
-	ctx->dirty_y = 0;
-	ctx->dirty_w = 128;
-	ctx->dirty_h = 32;
-	ctx->ticker_interval = 40;
+#if BUI_CTX_BAND_ROWS == 32
+	ctx->dirty[BUI_PRIORITY_NORMAL] = (bui_ctx_rect_t) { .x = 0, .y = 0, .w = 128, .h = 32 };
+	ctx->dirty[BUI_PRIORITY_HIGH] = (bui_ctx_rect_t) { .x = 0, .y = 0, .w = 0, .h = 0 };
+	ctx->stage_rect = (bui_ctx_rect_t) { .x = 0, .y = 0, .w = 0, .h = 0 };
+	ctx->packed = NULL;
+	ctx->lit_stale_y1 = 0;
+	ctx->lit_stale_y2 = 32;
+#else
+	ctx->band_y = 32;
+	ctx->lit_count = 0;
+#endif
+	ctx->ticker_idle_interval = 0;
+	ctx->ticker_request = 0xFFFF;
+	ctx->time = 0;
+	ctx->timers_active = 0;
 	ctx->event_handler = NULL;
+	ctx->event_mask = BUI_EVENT_MASK_ALL;
+	ctx->draw_callback = NULL;
+	ctx->font_cache = NULL;
 	ctx->button_left = false;
-	ctx->button_left_duration = 0;
+	ctx->button_left_time = 0;
 	ctx->button_left_prev = 0;
 	ctx->button_left_clicked = true; // This prevents a button clicked event from being triggered
 	ctx->button_right = false;
-	ctx->button_right_duration = 0;
+	ctx->button_right_time = 0;
 	ctx->button_right_prev = 0;
 	ctx->button_right_clicked = true; // This prevents a button clicked event from being triggered
+	ctx->display_in_flight = false;
+	ctx->frame_requested = BUI_CTX_BAND_ROWS != 32;
+	ctx->draw_priority = BUI_PRIORITY_NORMAL;
+	ctx->power_mode = BUI_POWER_MODE_NORMAL;
+	ctx->display_processed = false;
+	ctx->queue_len = 0;
 	bui_ctx_set_ticker(ctx, 40);
 }
 
+void* bui_ctx_get_transport_data(const bui_ctx_t *ctx) {
+	return ctx->transport_data;
+}
+
 bool bui_ctx_display(bui_ctx_t *ctx) {
 	if (bui_ctx_is_displayed(ctx))
 		return false;
@@ -488,18 +843,117 @@ bool bui_ctx_display(bui_ctx_t *ctx) {
 	return true;
 }
 
+void bui_ctx_request_frame(bui_ctx_t *ctx) {
+	ctx->frame_requested = true;
+}
+
+bool bui_ctx_is_frame_ready(const bui_ctx_t *ctx) {
+	return ctx->frame_requested && !ctx->display_in_flight && bui_ctx_is_displayed(ctx);
+}
+
+void bui_ctx_set_draw_callback(bui_ctx_t *ctx, bui_draw_callback_t draw_callback) {
+	if (draw_callback != NULL)
+		draw_callback = (bui_draw_callback_t) PIC(draw_callback);
+	ctx->draw_callback = draw_callback;
+}
+
+void bui_ctx_set_draw_priority(bui_ctx_t *ctx, bui_priority_t priority) {
+	ctx->draw_priority = priority;
+}
+
+bui_priority_t bui_ctx_get_draw_priority(const bui_ctx_t *ctx) {
+	return ctx->draw_priority;
+}
+
+void bui_ctx_set_power_mode(bui_ctx_t *ctx, bui_power_mode_t mode) {
+	if (mode == ctx->power_mode)
+		return;
+	ctx->power_mode = mode;
+#if BUI_CTX_BAND_ROWS == 32
+	bui_ctx_stale_lit(ctx, 0, 32);
+	// The entire display must be sent again using the new transform
+	if (ctx->packed != NULL) {
+		ctx->packed_next = ctx->packed;
+		ctx->packed_tile = 0;
+	} else {
+		ctx->dirty[BUI_PRIORITY_NORMAL] = (bui_ctx_rect_t) { .x = 0, .y = 0, .w = 128, .h = 32 };
+		ctx->stage_rect.w = 0;
+	}
+#else
+	ctx->frame_requested = true;
+#endif
+}
+
+bui_power_mode_t bui_ctx_get_power_mode(const bui_ctx_t *ctx) {
+	return ctx->power_mode;
+}
+
+uint16_t bui_ctx_count_lit_pixels(bui_ctx_t *ctx) {
+#if BUI_CTX_BAND_ROWS == 32
+	bui_ctx_unpack_screen(ctx);
+	// Only recount the rows that have been drawn to since they were last counted
+	for (uint8_t y = ctx->lit_stale_y1; y < ctx->lit_stale_y2; y++)
+		ctx->lit_rows[y] = bui_ctx_count_lit_row(ctx, y);
+	ctx->lit_stale_y1 = ctx->lit_stale_y2 = 0;
+	uint16_t count = 0;
+	for (uint8_t y = 0; y < 32; y++)
+		count += ctx->lit_rows[y];
+	return count;
+#else
+	return ctx->lit_count;
+#endif
+}
+
 uint16_t bui_ctx_get_ticker(bui_ctx_t *ctx) {
 	return ctx->ticker_interval;
 }
 
 void bui_ctx_set_ticker(bui_ctx_t *ctx, uint16_t interval) {
-	// Set the ticker interval to interval ms
-	G_io_seproxyhal_spi_buffer[0] = SEPROXYHAL_TAG_SET_TICKER_INTERVAL;
-	G_io_seproxyhal_spi_buffer[1] = 0; // Message length, high byte
-	G_io_seproxyhal_spi_buffer[2] = 2; // Message length, low byte
-	G_io_seproxyhal_spi_buffer[3] = (interval >> 8) & 0xFF; // Ticker interval, high byte
-	G_io_seproxyhal_spi_buffer[4] = interval & 0xFF; // Ticker interval, low byte
-	io_seproxyhal_spi_send(G_io_seproxyhal_spi_buffer, 5);
+	ctx->ticker_active_interval = interval;
+	bui_ctx_send_ticker(ctx, interval);
+}
+
+void bui_ctx_set_idle_ticker(bui_ctx_t *ctx, uint16_t interval) {
+	ctx->ticker_idle_interval = interval;
+	ctx->ticker_request = 0xFFFF;
+	if (interval == 0 && ctx->ticker_interval != ctx->ticker_active_interval)
+		bui_ctx_send_ticker(ctx, ctx->ticker_active_interval);
+}
+
+void bui_ctx_request_ticker(bui_ctx_t *ctx, uint16_t within) {
+	if (within < ctx->ticker_request)
+		ctx->ticker_request = within;
+}
+
+void bui_ctx_set_timer(bui_ctx_t *ctx, uint8_t timer, uint32_t delay, uint32_t period, bui_timer_callback_t callback) {
+	if (callback != NULL)
+		callback = (bui_timer_callback_t) PIC(callback);
+	ctx->timers[timer].deadline = ctx->time + delay;
+	ctx->timers[timer].period = period;
+	ctx->timers[timer].callback = callback;
+	ctx->timers_active |= 1 << timer;
+	bui_ctx_update_next_timer(ctx);
+	// Wake an idle ticker if it would otherwise sleep past the deadline
+	if (ctx->ticker_idle_interval != 0 && delay < ctx->ticker_interval
+			&& ctx->ticker_interval != ctx->ticker_active_interval)
+		bui_ctx_send_ticker(ctx, ctx->ticker_active_interval);
+}
+
+void bui_ctx_cancel_timer(bui_ctx_t *ctx, uint8_t timer) {
+	ctx->timers_active &= ~(1 << timer);
+	bui_ctx_update_next_timer(ctx);
+}
+
+bool bui_ctx_is_timer_set(const bui_ctx_t *ctx, uint8_t timer) {
+	return (ctx->timers_active & (1 << timer)) != 0;
+}
+
+uint32_t bui_ctx_get_next_timer(const bui_ctx_t *ctx) {
+	if (ctx->timers_active == 0)
+		return 0xFFFFFFFF;
+	if ((int32_t) (ctx->timer_next - ctx->time) <= 0)
+		return 0;
+	return ctx->timer_next - ctx->time;
 }
 
 void bui_ctx_set_event_handler(bui_ctx_t *ctx, bui_event_handler_t event_handler) {
@@ -508,186 +962,172 @@ void bui_ctx_set_event_handler(bui_ctx_t *ctx, bui_event_handler_t event_handler
 	ctx->event_handler = event_handler;
 }
 
-bool bui_ctx_seproxyhal_event(bui_ctx_t *ctx, bool allow_status) {
-	bool status_sent = false;
-	switch (G_io_seproxyhal_spi_buffer[0]) {
-	case SEPROXYHAL_TAG_BUTTON_PUSH_EVENT: {
-		unsigned int button_mask = G_io_seproxyhal_spi_buffer[3] >> 1;
-		uint8_t left = 0, right = 0; // 0 = no change, 1 = pressed, 2 = released, 3 = clicked
-		if ((button_mask & BUTTON_LEFT) != 0) {
-			if (!ctx->button_left) {
-				left = 1;
-				uint16_t prev = ctx->button_left_duration;
-				ctx->button_left = true;
-				ctx->button_left_duration = 0;
-				ctx->button_left_prev = prev < BUI_BUTTON_FAST_THRESHOLD ? 0 :
-						(prev < BUI_BUTTON_LONG_THRESHOLD ? 1 : 2);
-				ctx->button_left_clicked = false;
-			}
-		} else {
-			if (ctx->button_left) {
-				left = ctx->button_left_duration < BUI_BUTTON_LONG_THRESHOLD ? 3 : 2;
-				uint16_t prev = ctx->button_left_duration;
-				ctx->button_left = false;
-				ctx->button_left_duration = 0;
-				ctx->button_left_prev = prev < BUI_BUTTON_FAST_THRESHOLD ? 0 :
-						(prev < BUI_BUTTON_LONG_THRESHOLD ? 1 : 2);
-			}
-		}
-		if ((button_mask & BUTTON_RIGHT) != 0) {
-			if (!ctx->button_right) {
-				right = 1;
-				uint16_t prev = ctx->button_right_duration;
-				ctx->button_right = true;
-				ctx->button_right_duration = 0;
-				ctx->button_right_prev = prev < BUI_BUTTON_FAST_THRESHOLD ? 0 :
-						(prev < BUI_BUTTON_LONG_THRESHOLD ? 1 : 2);
-				ctx->button_right_clicked = false;
-			}
-		} else {
-			if (ctx->button_right) {
-				right = ctx->button_right_duration < BUI_BUTTON_LONG_THRESHOLD ? 3 : 2;
-				uint16_t prev = ctx->button_right_duration;
-				ctx->button_right = false;
-				ctx->button_right_duration = 0;
-				ctx->button_right_prev = prev < BUI_BUTTON_FAST_THRESHOLD ? 0 :
-						(prev < BUI_BUTTON_LONG_THRESHOLD ? 1 : 2);
-			}
-		}
-		switch (left) {
-		case 1: {
-			bui_event_data_button_pressed_t data = { .button = BUI_BUTTON_NANOS_LEFT };
-			bui_event_t event = { .id = BUI_EVENT_BUTTON_PRESSED, .data = &data };
-			bui_ctx_dispatch_event(ctx, &event);
-		} break;
-		case 2: {
-			bui_event_data_button_released_t data = { .button = BUI_BUTTON_NANOS_LEFT,
-					.prev_state = BUI_BUTTON_STATE_HELD };
-			bui_event_t event = { .id = BUI_EVENT_BUTTON_RELEASED, .data = &data };
-			bui_ctx_dispatch_event(ctx, &event);
-		} break;
-		case 3: {
-			bui_event_data_button_released_t data = { .button = BUI_BUTTON_NANOS_LEFT,
-					.prev_state = BUI_BUTTON_STATE_PRESSED };
-			bui_event_t event = { .id = BUI_EVENT_BUTTON_RELEASED, .data = &data };
-			bui_ctx_dispatch_event(ctx, &event);
-		} break;
-		}
-		switch (right) {
-		case 1: {
-			bui_event_data_button_pressed_t data = { .button = BUI_BUTTON_NANOS_RIGHT };
-			bui_event_t event = { .id = BUI_EVENT_BUTTON_PRESSED, .data = &data };
-			bui_ctx_dispatch_event(ctx, &event);
-		} break;
-		case 2: {
-			bui_event_data_button_released_t data = { .button = BUI_BUTTON_NANOS_RIGHT,
-					.prev_state = BUI_BUTTON_STATE_HELD };
-			bui_event_t event = { .id = BUI_EVENT_BUTTON_RELEASED, .data = &data };
-			bui_ctx_dispatch_event(ctx, &event);
-		} break;
-		case 3: {
-			bui_event_data_button_released_t data = { .button = BUI_BUTTON_NANOS_RIGHT,
-					.prev_state = BUI_BUTTON_STATE_PRESSED };
-			bui_event_t event = { .id = BUI_EVENT_BUTTON_RELEASED, .data = &data };
-			bui_ctx_dispatch_event(ctx, &event);
-		} break;
+void bui_ctx_set_event_mask(bui_ctx_t *ctx, bui_event_mask_t mask) {
+	ctx->event_mask = mask;
+}
+
+bui_event_mask_t bui_ctx_get_event_mask(const bui_ctx_t *ctx) {
+	return ctx->event_mask;
+}
+
+bool bui_parse_seproxyhal_event(const uint8_t *buff, bui_input_event_t *event) {
+	switch (buff[0]) {
+	case SEPROXYHAL_TAG_DISPLAY_PROCESSED_EVENT:
+		*event = (bui_input_event_t) { .type = BUI_INPUT_DISPLAY_PROCESSED, .value = 0 };
+		return true;
+	case SEPROXYHAL_TAG_BUTTON_PUSH_EVENT:
+		*event = (bui_input_event_t) { .type = BUI_INPUT_BUTTON_PUSH, .value = (buff[3] >> 1) & BUI_BUTTON_NANOS_BOTH };
+		return true;
+	case SEPROXYHAL_TAG_TICKER_EVENT:
+		*event = (bui_input_event_t) { .type = BUI_INPUT_TICKER, .value = 0 };
+		return true;
+	default:
+		return false;
+	}
+}
+
+void bui_ctx_queue_input_event(bui_ctx_t *ctx, const bui_input_event_t *event) {
+	bui_input_event_t queued = *event;
+	switch (queued.type) {
+	case BUI_INPUT_DISPLAY_PROCESSED:
+		ctx->display_processed = true;
+		return;
+	case BUI_INPUT_BUTTON_PUSH:
+		break;
+	case BUI_INPUT_TICKER:
+		if (queued.value == 0)
+			queued.value = ctx->ticker_interval;
+		break;
+	default:
+		return;
+	}
+	// Merge consecutive ticker events into one, so that the time elapsed is dispatched all at once
+	if (queued.type == BUI_INPUT_TICKER && ctx->queue_len != 0) {
+		bui_input_event_t *last = &ctx->queue[ctx->queue_len - 1];
+		if (last->type == BUI_INPUT_TICKER && last->value <= 0xFFFF - queued.value) {
+			last->value += queued.value;
+			return;
 		}
-	} break;
-	case SEPROXYHAL_TAG_DISPLAY_PROCESSED_EVENT: {
+	}
+	// If the queue is full, the oldest event is processed immediately to make room, since none may be lost
+	if (ctx->queue_len == BUI_CTX_EVENT_QUEUE_SIZE)
+		bui_ctx_process_queued(ctx);
+	ctx->queue[ctx->queue_len++] = queued;
+}
+
+void bui_ctx_queue_seproxyhal_event(bui_ctx_t *ctx) {
+	bui_input_event_t event;
+	if (bui_parse_seproxyhal_event(G_io_seproxyhal_spi_buffer, &event))
+		bui_ctx_queue_input_event(ctx, &event);
+}
+
+bool bui_ctx_process_events(bui_ctx_t *ctx, bool allow_status) {
+	bool status_sent = false;
+	// Process the queued events in the order in which they were received
+	while (ctx->queue_len != 0)
+		bui_ctx_process_queued(ctx);
+	if (ctx->display_processed) {
+		ctx->display_processed = false;
+		ctx->display_in_flight = false;
 		if (allow_status && !bui_ctx_is_displayed(ctx)) {
 			bui_ctx_send_display_status(ctx);
 			status_sent = true;
 			if (bui_ctx_is_displayed(ctx)) {
-				bui_event_t event = { .id = BUI_EVENT_DISPLAYED, .data = NULL };
+				bui_event_t event = { .id = BUI_EVENT_DISPLAYED, .time = ctx->time, .data = NULL };
 				bui_ctx_dispatch_event(ctx, &event);
 			}
 		}
-	} break;
-	case SEPROXYHAL_TAG_TICKER_EVENT: {
-		uint16_t elapsed = ctx->ticker_interval;
-		bool left_held, right_held;
-		{
-			// Elapse time for left button
-			uint16_t left_prev = ctx->button_left_duration;
-			uint16_t left_curr = left_prev + elapsed;
-			if (left_curr > 0x03FF)
-				left_curr = 0x03FF;
-			ctx->button_left_duration = left_curr;
-			left_held = ctx->button_left && left_prev < BUI_BUTTON_LONG_THRESHOLD
-					&& left_curr >= BUI_BUTTON_LONG_THRESHOLD;
-			// Elapse time for right button
-			uint16_t right_prev = ctx->button_right_duration;
-			uint16_t right_curr = right_prev + elapsed;
-			if (right_curr > 0x03FF)
-				right_curr = 0x03FF;
-			ctx->button_right_duration = right_curr;
-			right_held = ctx->button_right && right_prev < BUI_BUTTON_LONG_THRESHOLD
-					&& right_curr >= BUI_BUTTON_LONG_THRESHOLD;
-			// Emit button clicked events, if applicable
-			if (!ctx->button_left && !ctx->button_right) {
-				if (!ctx->button_left_clicked && left_prev == 0 && ctx->button_left_prev < 2) {
-					bui_button_id_t button = BUI_BUTTON_NANOS_LEFT;
-					ctx->button_left_clicked = true;
-					if (!ctx->button_right && !ctx->button_right_clicked && right_curr < BUI_BUTTON_LONG_THRESHOLD
-							&& ctx->button_right_prev < 2) {
-						button = BUI_BUTTON_NANOS_BOTH;
-						ctx->button_right_clicked = true;
-					}
-					bui_event_data_button_clicked_t data = { .button = button };
-					bui_event_t event = { .id = BUI_EVENT_BUTTON_CLICKED, .data = &data };
-					bui_ctx_dispatch_event(ctx, &event);
-				}
-				if (!ctx->button_right_clicked && right_prev == 0 && ctx->button_right_prev < 2) {
-					bui_button_id_t button = BUI_BUTTON_NANOS_RIGHT;
-					ctx->button_right_clicked = true;
-					if (!ctx->button_left && !ctx->button_left_clicked && left_curr < BUI_BUTTON_LONG_THRESHOLD
-							&& ctx->button_left_prev < 2) {
-						button = BUI_BUTTON_NANOS_BOTH;
-						ctx->button_left_clicked = true;
-					}
-					bui_event_data_button_clicked_t data = { .button = button };
-					bui_event_t event = { .id = BUI_EVENT_BUTTON_CLICKED, .data = &data };
-					bui_ctx_dispatch_event(ctx, &event);
-				}
-			}
+	}
+	// Begin a new frame if one was requested and the previous frame has been fully displayed; any requests made while
+	// the previous frame was being displayed are coalesced into this one
+	if (ctx->frame_requested && !ctx->display_in_flight) {
+		if (bui_ctx_is_displayed(ctx)) {
+			ctx->frame_requested = false;
+			bui_event_t event = { .id = BUI_EVENT_FRAME_READY, .time = ctx->time, .data = NULL };
+			bui_ctx_dispatch_event(ctx, &event);
+#if BUI_CTX_BAND_ROWS == 32
+			if (ctx->draw_callback != NULL)
+				ctx->draw_callback(ctx);
+#else
+			// The bands of the frame are drawn one at a time as they are sent
+			ctx->band_y = 0;
+#endif
 		}
-		// Dispatch button held events, if applicable
-		if (left_held || right_held) {
-			bui_event_data_button_held_t data;
-			bui_event_t event = { .id = BUI_EVENT_BUTTON_HELD, .data = &data };
-			if (left_held) {
-				data.button = BUI_BUTTON_NANOS_LEFT;
-				bui_ctx_dispatch_event(ctx, &event);
-			}
-			if (right_held) {
-				data.button = BUI_BUTTON_NANOS_RIGHT;
+		// Use the available status to send the new frame or whatever remains of the previous one
+		if (allow_status && !status_sent && !bui_ctx_is_displayed(ctx)) {
+			bui_ctx_send_display_status(ctx);
+			status_sent = true;
+			if (bui_ctx_is_displayed(ctx)) {
+				bui_event_t event = { .id = BUI_EVENT_DISPLAYED, .time = ctx->time, .data = NULL };
 				bui_ctx_dispatch_event(ctx, &event);
 			}
 		}
-		// Dispatch time elapsed event
-		bui_event_data_time_elapsed_t data = { .elapsed = elapsed };
-		bui_event_t event = { .id = BUI_EVENT_TIME_ELAPSED, .data = &data };
-		bui_ctx_dispatch_event(ctx, &event);
-	} break;
 	}
 	return status_sent;
 }
 
+bool bui_ctx_seproxyhal_event(bui_ctx_t *ctx, bool allow_status) {
+	bui_ctx_queue_seproxyhal_event(ctx);
+	return bui_ctx_process_events(ctx, allow_status);
+}
+
+bool bui_ctx_input_event(bui_ctx_t *ctx, const bui_input_event_t *event, bool allow_status) {
+	bui_ctx_queue_input_event(ctx, event);
+	return bui_ctx_process_events(ctx, allow_status);
+}
+
+void bui_ctx_loop_step(bui_ctx_t *ctx) {
+	bui_ctx_queue_seproxyhal_event(ctx);
+	bui_ctx_loop_step_input(ctx, NULL);
+}
+
+void bui_ctx_loop_step_input(bui_ctx_t *ctx, const bui_input_event_t *event) {
+	if (event != NULL)
+		bui_ctx_queue_input_event(ctx, event);
+	if (bui_ctx_process_events(ctx, true))
+		return;
+	if (!ctx->display_in_flight && !bui_ctx_is_displayed(ctx)) {
+		bui_ctx_send_display_status(ctx);
+		if (bui_ctx_is_displayed(ctx)) {
+			bui_event_t event = { .id = BUI_EVENT_DISPLAYED, .time = ctx->time, .data = NULL };
+			bui_ctx_dispatch_event(ctx, &event);
+		}
+	} else if (ctx->transport != NULL) {
+		((void (*)(bui_ctx_t*)) PIC(ctx->transport->general_status))(ctx);
+	} else {
+		io_seproxyhal_general_status();
+	}
+}
+
 bool bui_ctx_is_displayed(const bui_ctx_t *ctx) {
-	return ctx->dirty_w == 0 || ctx->dirty_h == 0;
+#if BUI_CTX_BAND_ROWS == 32
+	if (ctx->packed != NULL && ctx->packed_tile != 8)
+		return false;
+	for (uint8_t i = 0; i < 2; i++) {
+		if (ctx->dirty[i].w != 0 && ctx->dirty[i].h != 0)
+			return false;
+	}
+	return true;
+#else
+	return ctx->band_y >= 32;
+#endif
+}
+
+uint32_t bui_ctx_get_time(const bui_ctx_t *ctx) {
+	return ctx->time;
 }
 
 bui_button_state_t bui_ctx_get_button(const bui_ctx_t *ctx, bui_button_id_t button) {
 	if (button == BUI_BUTTON_NANOS_LEFT) {
 		if (ctx->button_left) {
-			return ctx->button_left_duration < BUI_BUTTON_LONG_THRESHOLD ?
+			return ctx->time - ctx->button_left_time < BUI_BUTTON_LONG_THRESHOLD ?
 					BUI_BUTTON_STATE_PRESSED : BUI_BUTTON_STATE_HELD;
 		} else {
 			return BUI_BUTTON_STATE_RELEASED;
 		}
 	} else {
 		if (ctx->button_right) {
-			return ctx->button_right_duration < BUI_BUTTON_LONG_THRESHOLD ?
+			return ctx->time - ctx->button_right_time < BUI_BUTTON_LONG_THRESHOLD ?
 					BUI_BUTTON_STATE_PRESSED : BUI_BUTTON_STATE_HELD;
 		} else {
 			return BUI_BUTTON_STATE_RELEASED;
@@ -696,7 +1136,7 @@ bui_button_state_t bui_ctx_get_button(const bui_ctx_t *ctx, bui_button_id_t butt
 }
 
 void bui_ctx_dispatch_event(bui_ctx_t *ctx, const bui_event_t *event) {
-	if (ctx->event_handler != NULL)
+	if (ctx->event_handler != NULL && (ctx->event_mask & BUI_EVENT_MASK(event->id)) != 0)
 		ctx->event_handler(ctx, event);
 }
 
@@ -705,40 +1145,58 @@ void bui_ctx_fill(bui_ctx_t *ctx, uint32_t color) {
 		return;
 	uint8_t best_index = bui_palette_find_best(bui_ctx_palette, 2, color);
 	os_memset(ctx->bb, best_index == 0 ? 0x00 : 0xFF, sizeof(ctx->bb));
-	// Set the new dirty rectangle
-	ctx->dirty_x = 0;
-	ctx->dirty_y = 0;
-	ctx->dirty_w = 128;
-	ctx->dirty_h = 32;
+#if BUI_CTX_BAND_ROWS == 32
+	// Set the new dirty rectangle and discard the staged display status and the packed full-screen image
+	ctx->dirty[ctx->draw_priority] = (bui_ctx_rect_t) { .x = 0, .y = 0, .w = 128, .h = 32 };
+	ctx->stage_rect.w = 0;
+	ctx->packed = NULL;
+	bui_ctx_stale_lit(ctx, 0, 32);
+#endif
 }
 
+#if BUI_CTX_BAND_ROWS == 32
+
+void bui_ctx_draw_packed_screen(bui_ctx_t *ctx, const uint8_t *packed) {
+	// The image covers the entire display, so everything waiting to be displayed is discarded
+	ctx->dirty[BUI_PRIORITY_NORMAL] = (bui_ctx_rect_t) { .x = 0, .y = 0, .w = 0, .h = 0 };
+	ctx->dirty[BUI_PRIORITY_HIGH] = (bui_ctx_rect_t) { .x = 0, .y = 0, .w = 0, .h = 0 };
+	ctx->stage_rect.w = 0;
+	ctx->packed = packed;
+	ctx->packed_next = packed;
+	ctx->packed_tile = 0;
+}
+
+#endif
+
 void bui_ctx_fill_rect(bui_ctx_t *ctx, int16_t x16, int16_t y16, int16_t w16, int16_t h16, uint32_t color) {
 	if (color >> 24 <= 127)
 		return;
 	int32_t x = x16, y = y16, w = w16, h = h16;
+	int32_t top = BUI_CTX_BAND_TOP(ctx);
+	int32_t bottom = BUI_CTX_BAND_BOTTOM(ctx);
 	if (x < 0) {
 		w += x;
 		x = 0;
 	}
-	if (y < 0) {
-		h += y;
-		y = 0;
+	if (y < top) {
+		h -= top - y;
+		y = top;
 	}
 	if (w <= 0 || h <= 0)
 		return;
-	if (x >= 128 || y >= 32)
+	if (x >= 128 || y >= bottom)
 		return;
 	if (x + w > 128)
 		w = 128 - x;
-	if (y + h > 32)
-		h = 32 - y;
+	if (y + h > bottom)
+		h = bottom - y;
 	// Determine best color index
 	uint8_t best_index = bui_palette_find_best(bui_ctx_palette, 2, color);
 	// Extend the dirty rectangle
 	bui_ctx_dirty(ctx, x, y, w, h);
 	// Calculate reflected coordinates
 	int32_t x1r = 128 - x - w; // index of the first column in the 2D bit array to be modified
-	int32_t y1r = 32 - y - h; // index of the first row in the 2D bit array to be modified
+	int32_t y1r = bottom - y - h; // index of the first row in the 2D bit array to be modified
 	int32_t x2r = x1r + w; // index just beyond the last column in the 2D bit array to be modified
 	int32_t y2r = y1r + h; // index just beyond the last row in the 2D bit array to be modified
 	// Blit the rectangle onto the display buffer
@@ -777,7 +1235,7 @@ void bui_ctx_fill_rect(bui_ctx_t *ctx, int16_t x16, int16_t y16, int16_t w16, in
 void bui_ctx_draw_pixel(bui_ctx_t *ctx, int16_t x, int16_t y, uint32_t color) {
 	if (color >> 24 <= 127)
 		return;
-	if (x < 0 || x >= 128 || y < 0 || y >= 32)
+	if (x < 0 || x >= 128 || y < BUI_CTX_BAND_TOP(ctx) || y >= BUI_CTX_BAND_BOTTOM(ctx))
 		return;
 	// Determine best color index
 	uint8_t best_index = bui_palette_find_best(bui_ctx_palette, 2, color);
@@ -785,7 +1243,7 @@ void bui_ctx_draw_pixel(bui_ctx_t *ctx, int16_t x, int16_t y, uint32_t color) {
 	bui_ctx_dirty(ctx, x, y, 1, 1);
 	// Reflect coordinates
 	x = 127 - x;
-	y = 31 - y;
+	y = BUI_CTX_BAND_BOTTOM(ctx) - 1 - y;
 	// Find destination
 	uint32_t dest_bit = y * 128 + x;
 	uint32_t dest_byte = dest_bit / 8;
@@ -800,16 +1258,18 @@ void bui_ctx_draw_pixel(bui_ctx_t *ctx, int16_t x, int16_t y, uint32_t color) {
 void bui_ctx_draw_bitmap(bui_ctx_t *ctx, bui_const_bitmap_t bmp, int16_t src_x16, int16_t src_y16, int16_t dest_x16,
 		int16_t dest_y16, int16_t w16, int16_t h16) {
 	int32_t src_x = src_x16, src_y = src_y16, dest_x = dest_x16, dest_y = dest_y16, w = w16, h = h16;
+	int32_t top = BUI_CTX_BAND_TOP(ctx);
+	int32_t bottom = BUI_CTX_BAND_BOTTOM(ctx);
 	// Shift source and destination coordinates to fit in their coordinate planes
 	if (dest_x < 0) {
 		src_x -= dest_x;
 		w += dest_x;
 		dest_x = 0;
 	}
-	if (dest_y < 0) {
-		src_y -= dest_y;
-		h += dest_y;
-		dest_y = 0;
+	if (dest_y < top) {
+		src_y += top - dest_y;
+		h -= top - dest_y;
+		dest_y = top;
 	}
 	if (src_x < 0) {
 		dest_x -= src_x;
@@ -823,12 +1283,12 @@ void bui_ctx_draw_bitmap(bui_ctx_t *ctx, bui_const_bitmap_t bmp, int16_t src_x16
 	}
 	if (w <= 0 || h <= 0)
 		return;
-	if (dest_x >= 128 || dest_y >= 32 || src_x >= bmp.w || src_y >= bmp.h)
+	if (dest_x >= 128 || dest_y >= bottom || src_x >= bmp.w || src_y >= bmp.h)
 		return;
 	if (dest_x + w > 128)
 		w = 128 - dest_x;
-	if (dest_y + h > 32)
-		h = 32 - dest_y;
+	if (dest_y + h > bottom)
+		h = bottom - dest_y;
 	if (src_x + w > bmp.w)
 		w = bmp.w - src_x;
 	if (src_y + h > bmp.h)
@@ -874,7 +1334,7 @@ void bui_ctx_draw_bitmap(bui_ctx_t *ctx, bui_const_bitmap_t bmp, int16_t src_x16
 		src_x = bmp.w - src_x - w;
 		src_y = bmp.h - src_y - h;
 		dest_x = 128 - dest_x - w; // index of the first column in the 2D bit array to be modified
-		dest_y = 32 - dest_y - h; // index of the first row in the 2D bit array to be modified
+		dest_y = bottom - dest_y - h; // index of the first row in the 2D bit array to be modified
 		// Blit the bitmap onto the display buffer using the determined bitblit function
 		for (int32_t i = 0; i < h; i++) {
 			uint32_t src_o = (src_y + i) * bmp.w + src_x;
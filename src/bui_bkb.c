@@ -306,6 +306,18 @@ bool bui_bkb_animate(bui_bkb_bkb_t *bkb, uint32_t elapsed) {
 	return change;
 }
 
+void bui_bkb_request_ticker(const bui_bkb_bkb_t *bkb, bui_ctx_t *ctx) {
+	if (bkb->keys_tick == 0x01FF)
+		return;
+	if (bkb->keys_tick < KEYS_ANIMATION_LEN || bkb->typed_tick < TYPED_ANIMATION_LEN) {
+		bui_ctx_request_ticker(ctx, 0);
+		return;
+	}
+	// Only the cursor is animating, and it only changes when it blinks
+	uint16_t cursor_tick = bkb->cursor_tick;
+	bui_ctx_request_ticker(ctx, CURSOR_ANIMATION_INT - cursor_tick % CURSOR_ANIMATION_INT);
+}
+
 void bui_bkb_draw(const bui_bkb_bkb_t *bkb, bui_ctx_t *ctx) {
 	// Locate textbox
 	uint8_t textbox_size = bkb->type_buff_cap + 1; // The number of slots in the textbox
@@ -323,6 +335,11 @@ void bui_bkb_draw(const bui_bkb_bkb_t *bkb, bui_ctx_t *ctx) {
 	if (textbox_cursor_i > 19)
 		textbox_cursor_i = 19;
 
+	// The textbox (including the cursor and the key just typed) is drawn with a high priority so that it's displayed
+	// before the rest of the keyboard
+	bui_priority_t priority = bui_ctx_get_draw_priority(ctx);
+	bui_ctx_set_draw_priority(ctx, BUI_PRIORITY_HIGH);
+
 	// Draw textbox slots
 	for (uint8_t i = 0; i < textbox_size; i++) {
 		bui_ctx_fill_rect(ctx, textbox_x + i * 6, 31, 5, 1, BUI_CLR_WHITE);
@@ -349,6 +366,8 @@ void bui_bkb_draw(const bui_bkb_bkb_t *bkb, bui_ctx_t *ctx) {
 		}
 	}
 
+	bui_ctx_set_draw_priority(ctx, priority);
+
 	// Draw center arrow icons
 	bui_ctx_draw_bitmap_full(ctx, BUI_BMP_ICON_LEFT, 58, 5);
 	bui_ctx_draw_bitmap_full(ctx, BUI_BMP_ICON_RIGHT, 66, 5);
@@ -23,29 +23,52 @@
 
 #include "bui_font.h"
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
 
 #include "os.h"
 
 #include "bui.h"
+#include "bui_internal.h"
 
 typedef struct __attribute__((packed)) {
 	uint16_t bitmap_offset; // The starting index of the character's bitmap in the font bitmap
 	uint8_t char_width; // Character width, in pixels
+	uint8_t ink_y; // The y-coordinate of the top row of the character's ink bounding box, relative to the character
+	uint8_t ink_height; // The height of the character's ink bounding box, in pixels; only these rows are stored
 } bui_font_char_t;
 
-// NOTE: Despite the font's range, they never include characters in the range 0x80 to 0x9F (both inclusive)
+// A range of consecutive character codes that all have bitmaps in a font
 typedef struct __attribute__((packed)) {
+	uint16_t first_code; // The character code of the first character in the range
+	uint16_t last_code; // The character code of the last character in the range
+	uint16_t first_index; // The index in the font's chars array of the first character in the range
+} bui_font_range_t;
+
+// NOTE: This struct is not packed, since info contains 16-bit fields to which pointers are returned
+typedef struct {
 	const bui_font_char_t *chars;
 	const uint8_t *bitmaps; // Array of bitmaps for all characters
 	bui_font_info_t info;
+	const bui_font_range_t *ranges; // The ranges of characters in the font, sorted by character code
+	uint8_t range_count; // The number of elements in ranges
 } bui_font_data_t;
 
-static const uint32_t bui_font_palette[] = {
-	BUI_CLR_TRANSPARENT,
-	BUI_CLR_WHITE,
-};
+// The header of a string bitmap stored in the arena of a bui_font_cache_t, immediately followed by the bitmap itself,
+// which is rendered by bui_font_render_run(...) and is as wide as the string (not including the kerning after the last
+// character) and as tall as the font
+typedef struct {
+	const char *str; // The string rendered
+	bui_font_t font; // The font in which the string was rendered
+	uint32_t last_use; // The value of the cache's clock when the bitmap was last drawn
+	uint16_t size; // The size of this entry (the header and the bitmap), in bytes; a multiple of BUI_FONT_CACHE_ALIGN
+	int16_t w; // The width of the string as calculated by bui_font_get_str_width(...)
+} bui_font_cache_entry_t;
+
+// The alignment of every entry in the arena of a bui_font_cache_t, in bytes; entries contain pointers, which may not
+// be accessed at unaligned addresses
+#define BUI_FONT_CACHE_ALIGN sizeof(void*)
 
 #include "bui_font_fonts.inc"
 
@@ -53,30 +76,101 @@ const bui_font_t bui_font_null = NULL;
 
 #define BUI_FONT_DATA_FOR_ID(id) ((const bui_font_data_t*) PIC(id))
 
-const bui_font_info_t* bui_font_get_font_info(bui_font_t font) {
-	return &BUI_FONT_DATA_FOR_ID(font)->info;
+/*
+ * Decode the character at the start of a string encoded in UTF-8. Any byte that does not begin a valid UTF-8 sequence
+ * of at most 3 bytes is decoded by itself as a Latin-1 (ISO 8859-1) character, so that strings encoded in Latin-1
+ * (which includes all ASCII strings) continue to be supported.
+ *
+ * Args:
+ *     str: the string; must have at least one byte
+ *     len: the maximum number of bytes in the string which may be read
+ *     code_dest: a pointer to an int in which the character code (the Unicode code point) will be stored
+ * Returns:
+ *     the number of bytes in the character; this is in [1, 3] and is <= len
+ */
+static uint8_t bui_font_decode_char(const char *str, uint16_t len, uint16_t *code_dest) {
+	const uint8_t *bytes = (const uint8_t*) str;
+	uint8_t lead = bytes[0];
+	if (lead < 0x80) {
+		*code_dest = lead;
+		return 1;
+	}
+	if (lead >= 0xC2 && lead <= 0xDF && len >= 2 && (bytes[1] & 0xC0) == 0x80) {
+		*code_dest = ((uint16_t) (lead & 0x1F) << 6) | (bytes[1] & 0x3F);
+		return 2;
+	}
+	if (lead >= 0xE0 && lead <= 0xEF && len >= 3 && (bytes[1] & 0xC0) == 0x80 && (bytes[2] & 0xC0) == 0x80) {
+		uint16_t code = ((uint16_t) (lead & 0x0F) << 12) | ((uint16_t) (bytes[1] & 0x3F) << 6) | (bytes[2] & 0x3F);
+		// Overlong encodings are rejected
+		if (code >= 0x800) {
+			*code_dest = code;
+			return 3;
+		}
+	}
+	*code_dest = lead;
+	return 1;
 }
 
-uint8_t bui_font_get_char_width(bui_font_t font, char ch) {
-	const bui_font_data_t *font_data = BUI_FONT_DATA_FOR_ID(font);
-	uint8_t chari = ch;
-	if (chari >= 0x80)
-		chari -= 0xA0 - 0x80;
-	chari -= font_data->info.first_char;
-	return ((const bui_font_char_t*) PIC(font_data->chars))[chari].char_width;
+/*
+ * Find the character with the specified character code in a font, using a binary search over the font's ranges. The
+ * first range, which usually holds the most common characters, is checked before searching.
+ *
+ * Args:
+ *     font_data: the data for the font, already passed through PIC(...)
+ *     chars: font_data->chars, already passed through PIC(...)
+ *     ranges: font_data->ranges, already passed through PIC(...)
+ *     code: the character code
+ * Returns:
+ *     a pointer to the character, or NULL if the font has no bitmap for the character
+ */
+static const bui_font_char_t* bui_font_find_char(const bui_font_data_t *font_data, const bui_font_char_t *chars,
+		const bui_font_range_t *ranges, uint16_t code) {
+	if (code >= ranges[0].first_code && code <= ranges[0].last_code)
+		return &chars[ranges[0].first_index + (code - ranges[0].first_code)];
+	uint8_t lo = 1, hi = font_data->range_count;
+	while (lo < hi) {
+		uint8_t mid = lo + (hi - lo) / 2;
+		if (code < ranges[mid].first_code)
+			hi = mid;
+		else if (code > ranges[mid].last_code)
+			lo = mid + 1;
+		else
+			return &chars[ranges[mid].first_index + (code - ranges[mid].first_code)];
+	}
+	return NULL;
 }
 
-int16_t bui_font_get_str_width(bui_font_t font, const char *str) {
-	const bui_font_data_t *font_data = BUI_FONT_DATA_FOR_ID(font);
+/*
+ * Find the character with the specified character code in a font, as with bui_font_find_char(...), but passing the
+ * font's tables through PIC(...) first. This is intended for looking up a single character.
+ */
+static const bui_font_char_t* bui_font_lookup_char(const bui_font_data_t *font_data, uint16_t code) {
+	return bui_font_find_char(font_data, (const bui_font_char_t*) PIC(font_data->chars),
+			(const bui_font_range_t*) PIC(font_data->ranges), code);
+}
+
+/*
+ * Measure the width of a run of characters in a font, as described for bui_font_get_str_width(...).
+ *
+ * Args:
+ *     font_data: the data for the font, already passed through PIC(...)
+ *     str: the characters, encoded in UTF-8; the run ends early at the first '\0', if any
+ *     len: the maximum number of bytes in the run
+ * Returns:
+ *     the width of the run, in pixels, or 1023 if it is greater than 1023
+ */
+static int16_t bui_font_measure(const bui_font_data_t *font_data, const char *str, uint16_t len) {
 	const bui_font_char_t *chars = (const bui_font_char_t*) PIC(font_data->chars);
-	uint8_t first_char = font_data->info.first_char;
+	const bui_font_range_t *ranges = (const bui_font_range_t*) PIC(font_data->ranges);
 	uint8_t char_kerning = font_data->info.char_kerning;
 	int16_t w = 0;
-	for (uint8_t chari; (chari = *str) != '\0'; str++) {
-		if (chari >= 0x80)
-			chari -= 0xA0 - 0x80;
-		chari -= first_char;
-		w += chars[chari].char_width;
+	for (uint16_t i = 0; i < len && str[i] != '\0';) {
+		uint16_t code;
+		i += bui_font_decode_char(&str[i], len - i, &code);
+		const bui_font_char_t *font_char = bui_font_find_char(font_data, chars, ranges, code);
+		if (font_char == NULL)
+			continue;
+		w += font_char->char_width;
 		w += char_kerning;
 		if (w >= 1023)
 			return 1023;
@@ -84,43 +178,206 @@ int16_t bui_font_get_str_width(bui_font_t font, const char *str) {
 	return w;
 }
 
+const bui_font_info_t* bui_font_get_font_info(bui_font_t font) {
+	return &BUI_FONT_DATA_FOR_ID(font)->info;
+}
+
+bool bui_font_has_char(bui_font_t font, uint16_t code) {
+	return bui_font_lookup_char(BUI_FONT_DATA_FOR_ID(font), code) != NULL;
+}
+
+uint8_t bui_font_get_char_width(bui_font_t font, char ch) {
+	const bui_font_char_t *font_char = bui_font_lookup_char(BUI_FONT_DATA_FOR_ID(font), (uint8_t) ch);
+	return font_char != NULL ? font_char->char_width : 0;
+}
+
+int16_t bui_font_get_str_width(bui_font_t font, const char *str) {
+	return bui_font_measure(BUI_FONT_DATA_FOR_ID(font), str, 0xFFFF);
+}
+
 int16_t bui_font_get_char_buff_width(bui_font_t font, const char *char_buff, uint8_t len) {
-	const bui_font_data_t *font_data = BUI_FONT_DATA_FOR_ID(font);
-	const bui_font_char_t *chars = (const bui_font_char_t*) PIC(font_data->chars);
-	uint8_t first_char = font_data->info.first_char;
-	uint8_t char_kerning = font_data->info.char_kerning;
-	int16_t w = 0;
-	for (uint8_t i = 0; i < len; i++) {
-		uint8_t chari = char_buff[i];
-		if (chari >= 0x80)
-			chari -= 0xA0 - 0x80;
-		chari -= first_char;
-		w += chars[chari].char_width;
-		w += char_kerning;
-		if (w >= 1023)
-			return 1023;
-	}
-	return w;
+	return bui_font_measure(BUI_FONT_DATA_FOR_ID(font), char_buff, len);
 }
 
 const uint8_t* bui_font_get_char_bitmap(bui_font_t font, char ch, int16_t *w_dest) {
 	const bui_font_data_t *font_data = BUI_FONT_DATA_FOR_ID(font);
-	uint8_t chari = ch;
-	if (chari >= 0x80)
-		chari -= 0xA0 - 0x80;
-	chari -= font_data->info.first_char;
+	const bui_font_char_t *font_char_ptr = bui_font_lookup_char(font_data, (uint8_t) ch);
+	if (font_char_ptr == NULL)
+		return NULL;
 	bui_font_char_t font_char;
-	os_memcpy(&font_char, &((const bui_font_char_t*) PIC(font_data->chars))[chari], sizeof(bui_font_char_t));
+	os_memcpy(&font_char, font_char_ptr, sizeof(bui_font_char_t));
 	if (w_dest != NULL)
 		*w_dest = font_char.char_width;
 	return (const uint8_t*) PIC(font_data->bitmaps) + font_char.bitmap_offset;
 }
 
+void bui_font_get_char_ink(bui_font_t font, char ch, uint8_t *y_dest, uint8_t *h_dest) {
+	const bui_font_char_t *font_char_ptr = bui_font_lookup_char(BUI_FONT_DATA_FOR_ID(font), (uint8_t) ch);
+	if (font_char_ptr == NULL) {
+		*y_dest = 0;
+		*h_dest = 0;
+		return;
+	}
+	bui_font_char_t font_char;
+	os_memcpy(&font_char, font_char_ptr, sizeof(bui_font_char_t));
+	*y_dest = font_char.ink_y;
+	*h_dest = font_char.ink_height;
+}
+
+/*
+ * Render a run of characters in the specified font onto a 1-bit bitmap encoded like the display buffer (with its rows
+ * and columns reversed), by ORing the bits of every visible character's bitmap into it row by row. Columns of the run
+ * outside of the bitmap are clipped, but rows are not; only the rows [row1, row2) of the run are rendered, and they
+ * must all lie within the bitmap.
+ *
+ * Args:
+ *     font_data: the data for the font, already passed through PIC(...)
+ *     chars: the characters in the run; the run ends early at the first '\0', if any
+ *     len: the maximum number of characters in the run
+ *     x: the x-coordinate of the left edge of the run within the bitmap
+ *     row1: the first row of the run to be rendered
+ *     row2: the row of the run just below the last row to be rendered; must be > row1
+ *     dest: the bitmap
+ *     dest_w: the width of the bitmap, in pixels
+ *     dest_bottom: the row of the run just below the last row of the bitmap
+ */
+static void bui_font_render_run(const bui_font_data_t *font_data, const char *chars, uint16_t len, int16_t x,
+		int16_t row1, int16_t row2, uint8_t *dest, int16_t dest_w, int16_t dest_bottom) {
+	uint8_t char_kerning = font_data->info.char_kerning;
+	// Bitmaps are stored reflected, so the last visible row of each character is blitted first
+	const bui_font_char_t *font_chars = (const bui_font_char_t*) PIC(font_data->chars);
+	const bui_font_range_t *ranges = (const bui_font_range_t*) PIC(font_data->ranges);
+	const uint8_t *bitmaps = (const uint8_t*) PIC(font_data->bitmaps);
+	bool aligned = (font_data->info.flags & BUI_FONT_FLAG_ALIGNED_ROWS) != 0;
+	bool compressed = (font_data->info.flags & BUI_FONT_FLAG_COMPRESSED_ROWS) != 0;
+	for (uint16_t i = 0; i < len && chars[i] != '\0' && x < dest_w;) {
+		uint16_t code;
+		i += bui_font_decode_char(&chars[i], len - i, &code);
+		const bui_font_char_t *font_char = bui_font_find_char(font_data, font_chars, ranges, code);
+		if (font_char == NULL)
+			continue;
+		int16_t char_w = font_char->char_width;
+		int16_t ink_y = font_char->ink_y;
+		int16_t ink_h = font_char->ink_height;
+		// Only the rows of the character's ink bounding box are stored, and only those that are visible are blitted
+		int16_t ink_row1 = row1 > ink_y ? row1 : ink_y;
+		int16_t ink_row2 = row2 < ink_y + ink_h ? row2 : ink_y + ink_h;
+		if (char_w != 0 && x + char_w > 0 && ink_row1 < ink_row2) {
+			int16_t col1 = x < 0 ? -x : 0; // The first column of the character that is visible
+			int16_t col2 = x + char_w > dest_w ? dest_w - x : char_w; // The column just after the last visible one
+			const uint8_t *bitmap = bitmaps + font_char->bitmap_offset;
+			// If rows are aligned, every row of an unclipped character begins on a byte boundary
+			uint8_t stride = aligned ? (char_w + 7) & ~0x07 : char_w;
+			uint8_t rows = ink_row2 - ink_row1;
+			uint8_t src_row = ink_y + ink_h - ink_row2;
+			uint32_t dest_bit = (uint32_t) (dest_bottom - ink_row2) * dest_w + (dest_w - x - col2);
+			if (!compressed) {
+				uint32_t src_bit = src_row * stride + (char_w - col2);
+				for (uint8_t row = 0; row < rows; row++) {
+					bui_bitblit_or(&bitmap[src_bit / 8], src_bit % 8, &dest[dest_bit / 8], dest_bit % 8, col2 - col1);
+					src_bit += stride;
+					dest_bit += dest_w;
+				}
+			} else {
+				// Walk the repeat bits from the first row, since the position of each stored row depends on the number
+				// of rows stored before it; rows before the first stored row are blank and are skipped
+				const uint8_t *stored = bitmap + (ink_h + 7) / 8;
+				int16_t stored_row = -1; // The index of the stored row that the current row is identical to
+				for (uint8_t row = 0; row < src_row + rows; row++) {
+					if ((bitmap[row / 8] & (0x80 >> (row % 8))) == 0)
+						stored_row += 1;
+					if (row < src_row)
+						continue;
+					if (stored_row != -1) {
+						uint32_t src_bit = stored_row * stride + (char_w - col2);
+						bui_bitblit_or(&stored[src_bit / 8], src_bit % 8, &dest[dest_bit / 8], dest_bit % 8,
+								col2 - col1);
+					}
+					dest_bit += dest_w;
+				}
+			}
+		}
+		x += char_w;
+		x += char_kerning;
+	}
+}
+
+/*
+ * Draw a bitmap rendered by bui_font_render_run(...) onto the display of a BUI context, in white with a transparent
+ * background. The bitmap is clipped and the dirty rectangle is extended, after which every visible row of the bitmap is
+ * blitted directly onto the display buffer.
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     bb: the bitmap, rendered with its rows and columns reversed like the display buffer
+ *     bb_w: the width of the bitmap, in pixels
+ *     bb_h: the height of the bitmap, in pixels
+ *     x: the x-coordinate of the left edge of the bitmap
+ *     y: the y-coordinate of the top edge of the bitmap
+ */
+static void bui_font_draw_rendered(bui_ctx_t *ctx, const uint8_t *bb, int16_t bb_w, uint8_t bb_h, int16_t x,
+		int16_t y) {
+	int16_t top = BUI_CTX_BAND_TOP(ctx);
+	int16_t bottom = BUI_CTX_BAND_BOTTOM(ctx);
+	int16_t row1 = y < top ? top - y : 0; // The first row of the bitmap that is visible
+	int16_t row2 = y + bb_h > bottom ? bottom - y : bb_h; // The row just below the last visible row of the bitmap
+	int16_t x1 = x < 0 ? 0 : x;
+	int16_t x2 = x + bb_w > 128 ? 128 : x + bb_w;
+	if (row1 >= row2 || x1 >= x2)
+		return;
+	bui_ctx_dirty(ctx, x1, y + row1, x2 - x1, row2 - row1);
+	// The bitmap is reflected like the display buffer, so its visible rows are blitted from the last to the first
+	uint32_t src_bit = (uint32_t) (bb_h - row2) * bb_w + (x + bb_w - x2);
+	uint32_t dest_bit = (uint32_t) (bottom - y - row2) * 128 + (128 - x2);
+	for (int16_t row = row1; row < row2; row++) {
+		bui_bitblit_or(&bb[src_bit / 8], src_bit % 8, &ctx->bb[dest_bit / 8], dest_bit % 8, x2 - x1);
+		src_bit += bb_w;
+		dest_bit += 128;
+	}
+}
+
+/*
+ * Draw a run of characters in the specified font onto the display of a BUI context, in white with a transparent
+ * background. The run is clipped and the dirty rectangle is extended only once for the entire run, after which every
+ * visible character is blitted directly onto the display buffer row by row (or the visible part of the run's cached
+ * bitmap is, if it has one).
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     font_data: the data for the font, already passed through PIC(...)
+ *     chars: the characters in the run; the run ends early at the first '\0', if any
+ *     len: the maximum number of characters in the run
+ *     x: the x-coordinate of the left edge of the run
+ *     y: the y-coordinate of the top edge of the run
+ *     w: the width of the run as calculated by bui_font_get_str_width(...) or bui_font_get_char_buff_width(...)
+ *     cached: the bitmap of the run as rendered by bui_font_render_run(...) onto a bitmap exactly as wide as the run
+ *             (not including the kerning after the last character) and as tall as the font, or NULL if there is none
+ */
+static void bui_font_draw_run(bui_ctx_t *ctx, const bui_font_data_t *font_data, const char *chars, uint16_t len,
+		int16_t x, int16_t y, int16_t w, const uint8_t *cached) {
+	uint8_t h = font_data->info.char_height;
+	uint8_t char_kerning = font_data->info.char_kerning;
+	if (cached != NULL) {
+		bui_font_draw_rendered(ctx, cached, w - char_kerning, h, x, y);
+		return;
+	}
+	// Clip the run as a whole
+	int16_t top = BUI_CTX_BAND_TOP(ctx);
+	int16_t bottom = BUI_CTX_BAND_BOTTOM(ctx);
+	int16_t row1 = y < top ? top - y : 0; // The first row of the characters that is visible
+	int16_t row2 = y + h > bottom ? bottom - y : h; // The row just below the last row of the characters that is visible
+	int16_t x1 = x < 0 ? 0 : x;
+	int16_t x2 = w >= 1023 || x + w - char_kerning > 128 ? 128 : x + w - char_kerning;
+	if (row1 >= row2 || x1 >= x2)
+		return;
+	bui_ctx_dirty(ctx, x1, y + row1, x2 - x1, row2 - row1);
+	bui_font_render_run(font_data, chars, len, x, row1, row2, ctx->bb, 128, bottom - y);
+}
+
 void bui_font_draw_char(bui_ctx_t *ctx, char ch, int16_t x, int16_t y, bui_dir_t alignment, bui_font_t font) {
-	const bui_font_info_t *font_info = bui_font_get_font_info(font);
-	int16_t h = font_info->char_height;
-	int16_t w;
-	const uint8_t *bitmap = bui_font_get_char_bitmap(font, ch, &w);
+	const bui_font_data_t *font_data = BUI_FONT_DATA_FOR_ID(font);
+	int16_t h = font_data->info.char_height;
+	int16_t w = bui_font_get_char_width(font, ch);
 	if (BUI_DIR_IS_HTL_CENTER(alignment)) {
 		x -= w / 2;
 		if (w % 2 == 1)
@@ -135,88 +392,356 @@ void bui_font_draw_char(bui_ctx_t *ctx, char ch, int16_t x, int16_t y, bui_dir_t
 	} else if (BUI_DIR_IS_BOTTOM(alignment)) {
 		y -= h;
 	}
-	bui_ctx_draw_bitmap_full(ctx, (bui_const_bitmap_t) {
-		.w = w,
-		.h = h,
-		.bb = bitmap,
-		.plt = bui_font_palette,
-		.bpp = 1,
-	}, x, y);
+	bui_font_draw_run(ctx, font_data, &ch, 1, x, y, w + font_data->info.char_kerning, NULL);
 }
 
-void bui_font_draw_string(bui_ctx_t *ctx, const char *str, int16_t x, int16_t y, bui_dir_t alignment, bui_font_t font) {
-	const bui_font_info_t *font_info = bui_font_get_font_info(font);
+/*
+ * Move the anchor of a run of characters to the top-left corner of the run, according to the run's alignment.
+ *
+ * Args:
+ *     x: a pointer to the x-coordinate of the text anchor, which is replaced by that of the left edge of the run
+ *     y: a pointer to the y-coordinate of the text anchor, which is replaced by that of the top edge of the run
+ *     w: the width of the run as calculated by bui_font_get_str_width(...) or bui_font_get_char_buff_width(...)
+ *     baseline_height: the baseline height of the run's font
+ *     alignment: the position of the anchor within the text boundaries
+ */
+static void bui_font_align(int16_t *x, int16_t *y, int16_t w, uint8_t baseline_height, bui_dir_t alignment) {
 	if (BUI_DIR_IS_VTL_CENTER(alignment)) {
-		y -= font_info->baseline_height / 2;
-		if (font_info->baseline_height % 2 == 1)
-			y -= 1;
+		*y -= baseline_height / 2;
+		if (baseline_height % 2 == 1)
+			*y -= 1;
 	} else if (BUI_DIR_IS_BOTTOM(alignment)) {
-		y -= font_info->baseline_height;
+		*y -= baseline_height;
 	}
-	if (y >= 32 || y + font_info->char_height <= 0)
-		return;
 	if (!BUI_DIR_IS_LEFT(alignment)) {
-		int16_t w = bui_font_get_str_width(font, str);
 		if (BUI_DIR_IS_HTL_CENTER(alignment)) {
-			x -= w / 2;
+			*x -= w / 2;
 			if (w % 2 == 1)
-				x -= 1;
+				*x -= 1;
 		} else {
-			x -= w;
+			*x -= w;
 		}
-		if (x + w <= 0)
-			return;
 	}
-	for (; *str != '\0' && x < 128; str++) {
-		int16_t w;
-		const uint8_t *bitmap = bui_font_get_char_bitmap(font, *str, &w);
-		bui_ctx_draw_bitmap_full(ctx, (bui_const_bitmap_t) {
-			.w = w,
-			.h = font_info->char_height,
-			.bb = bitmap,
-			.plt = bui_font_palette,
-			.bpp = 1,
-		}, x, y);
-		x += w;
-		x += font_info->char_kerning;
+}
+
+/*
+ * Align a run of characters in the specified font relative to an anchor and draw it onto the display of a BUI context.
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     font_data: the data for the font, already passed through PIC(...)
+ *     chars: the characters in the run; the run ends early at the first '\0', if any
+ *     len: the maximum number of characters in the run
+ *     x: the x-coordinate of the text anchor
+ *     y: the y-coordinate of the text anchor
+ *     w: the width of the run as calculated by bui_font_get_str_width(...) or bui_font_get_char_buff_width(...)
+ *     alignment: the position of the anchor within the text boundaries
+ *     cached: the cached bitmap of the run (see bui_font_draw_run(...)), or NULL if there is none
+ */
+static void bui_font_draw_aligned(bui_ctx_t *ctx, const bui_font_data_t *font_data, const char *chars, uint16_t len,
+		int16_t x, int16_t y, int16_t w, bui_dir_t alignment, const uint8_t *cached) {
+	const bui_font_info_t *font_info = &font_data->info;
+	bui_font_align(&x, &y, w, font_info->baseline_height, alignment);
+	if (y >= 32 || y + font_info->char_height <= 0)
+		return;
+	bui_font_draw_run(ctx, font_data, chars, len, x, y, w, cached);
+}
+
+/*
+ * Evict the least recently drawn bitmap from a string bitmap cache, moving the bitmaps after it down to fill the space
+ * it occupied.
+ *
+ * Args:
+ *     cache: the cache; must contain at least one bitmap
+ */
+static void bui_font_cache_evict(bui_font_cache_t *cache) {
+	uint16_t lru_i = 0;
+	uint32_t lru_age = 0;
+	const bui_font_cache_entry_t *entry;
+	for (uint16_t i = 0; i < cache->used; i += entry->size) {
+		entry = (const bui_font_cache_entry_t*) &cache->arena[i];
+		if (cache->clock - entry->last_use >= lru_age) {
+			lru_i = i;
+			lru_age = cache->clock - entry->last_use;
+		}
 	}
+	uint16_t size = ((const bui_font_cache_entry_t*) &cache->arena[lru_i])->size;
+	os_memmove(&cache->arena[lru_i], &cache->arena[lru_i + size], cache->used - lru_i - size);
+	cache->used -= size;
 }
 
-void bui_font_draw_char_buff(bui_ctx_t *ctx, const char *char_buff, uint8_t len, int16_t x, int16_t y,
-		bui_dir_t alignment, bui_font_t font) {
-	const bui_font_info_t *font_info = bui_font_get_font_info(font);
-	if (BUI_DIR_IS_VTL_CENTER(alignment)) {
-		y -= font_info->baseline_height / 2;
-		if (font_info->baseline_height % 2 == 1)
-			y -= 1;
-	} else if (BUI_DIR_IS_BOTTOM(alignment)) {
-		y -= font_info->baseline_height;
+/*
+ * Find the bitmap of a string in a string bitmap cache.
+ *
+ * Args:
+ *     cache: the cache
+ *     font: the font
+ *     str: the null-terminated string
+ * Returns:
+ *     the cache entry for the string, or NULL if it isn't cached
+ */
+static bui_font_cache_entry_t* bui_font_cache_find(bui_font_cache_t *cache, bui_font_t font, const char *str) {
+	bui_font_cache_entry_t *entry;
+	for (uint16_t i = 0; i < cache->used; i += entry->size) {
+		entry = (bui_font_cache_entry_t*) &cache->arena[i];
+		if (entry->str == str && entry->font == font)
+			return entry;
 	}
-	if (y >= 32 || y + font_info->char_height <= 0)
+	return NULL;
+}
+
+/*
+ * Render a string and cache its bitmap in a string bitmap cache, evicting the least recently drawn bitmaps to make room
+ * for it. The string must not already be cached.
+ *
+ * Args:
+ *     cache: the cache
+ *     font_data: the data for the font, already passed through PIC(...)
+ *     font: the font
+ *     str: the null-terminated string
+ *     w: the width of the string as calculated by bui_font_get_str_width(...)
+ * Returns:
+ *     the cache entry for the string, or NULL if the string can't be cached (because its bitmap is too large for the
+ *     cache's arena or it is empty)
+ */
+static bui_font_cache_entry_t* bui_font_cache_add(bui_font_cache_t *cache, const bui_font_data_t *font_data,
+		bui_font_t font, const char *str, int16_t w) {
+	uint8_t h = font_data->info.char_height;
+	int16_t cached_w = w - font_data->info.char_kerning;
+	if (w >= 1023 || cached_w <= 0)
+		return NULL;
+	uint16_t bb_size = ((uint32_t) cached_w * h + 7) / 8;
+	uint32_t size = (sizeof(bui_font_cache_entry_t) + bb_size + BUI_FONT_CACHE_ALIGN - 1) & ~(BUI_FONT_CACHE_ALIGN - 1);
+	if (size > cache->size)
+		return NULL;
+	while ((uint32_t) cache->size - cache->used < size)
+		bui_font_cache_evict(cache);
+	bui_font_cache_entry_t *entry = (bui_font_cache_entry_t*) &cache->arena[cache->used];
+	entry->str = str;
+	entry->font = font;
+	entry->last_use = cache->clock;
+	entry->size = size;
+	entry->w = w;
+	uint8_t *bb = (uint8_t*) (entry + 1);
+	os_memset(bb, 0, bb_size);
+	bui_font_render_run(font_data, str, 0xFFFF, 0, 0, h, bb, cached_w, h);
+	cache->used += size;
+	return entry;
+}
+
+void bui_font_draw_string(bui_ctx_t *ctx, const char *str, int16_t x, int16_t y, bui_dir_t alignment, bui_font_t font) {
+	const bui_font_data_t *font_data = BUI_FONT_DATA_FOR_ID(font);
+	bui_font_cache_t *cache = ctx->font_cache;
+	if (cache == NULL) {
+		bui_font_draw_aligned(ctx, font_data, str, 0xFFFF, x, y, bui_font_get_str_width(font, str), alignment, NULL);
 		return;
-	if (!BUI_DIR_IS_LEFT(alignment)) {
-		int16_t w = bui_font_get_char_buff_width(font, char_buff, len);
-		if (BUI_DIR_IS_HTL_CENTER(alignment)) {
-			x -= w / 2;
-			if (w % 2 == 1)
-				x -= 1;
+	}
+	bui_font_cache_entry_t *entry = bui_font_cache_find(cache, font, str);
+	int16_t w = entry != NULL ? entry->w : bui_font_measure(font_data, str, 0xFFFF);
+	// Strings that are entirely off-screen are neither cached nor counted, so that they never evict visible strings
+	int16_t run_x = x;
+	int16_t run_y = y;
+	bui_font_align(&run_x, &run_y, w, font_data->info.baseline_height, alignment);
+	int16_t first_row = run_y > 0 ? run_y : 0; // The first row of the display in which the string is visible
+	if (run_x >= 128 || run_x + w - font_data->info.char_kerning <= 0 || run_y + font_data->info.char_height <= 0
+			|| first_row >= 32)
+		return;
+	// In band mode, a string is only counted (and cached) in the first band in which it is visible, so that it is
+	// counted once per frame
+	if (first_row >= BUI_CTX_BAND_TOP(ctx) && first_row < BUI_CTX_BAND_BOTTOM(ctx)) {
+		cache->clock += 1;
+		if (entry != NULL) {
+			entry->last_use = cache->clock;
+			cache->hits += 1;
 		} else {
-			x -= w;
+			cache->misses += 1;
+			entry = bui_font_cache_add(cache, font_data, font, str, w);
 		}
-		if (x + w <= 0)
-			return;
-	}
-	for (uint8_t i = 0; i < len && x < 128; i++) {
-		int16_t w;
-		const uint8_t *bitmap = bui_font_get_char_bitmap(font, char_buff[i], &w);
-		bui_ctx_draw_bitmap_full(ctx, (bui_const_bitmap_t) {
-			.w = w,
-			.h = font_info->char_height,
-			.bb = bitmap,
-			.plt = bui_font_palette,
-			.bpp = 1,
-		}, x, y);
-		x += w;
-		x += font_info->char_kerning;
 	}
+	bui_font_draw_aligned(ctx, font_data, str, 0xFFFF, x, y, w, alignment,
+			entry != NULL ? (const uint8_t*) (entry + 1) : NULL);
+}
+
+void bui_font_draw_text(bui_ctx_t *ctx, const bui_font_text_t *text, int16_t x, int16_t y, bui_dir_t alignment) {
+	text = (const bui_font_text_t*) PIC(text);
+	if (text->bb == NULL)
+		return;
+	bui_font_align(&x, &y, text->w, text->baseline_height, alignment);
+	bui_font_draw_rendered(ctx, (const uint8_t*) PIC(text->bb), text->bb_w, text->ink_height, x, y + text->ink_y);
+}
+
+void bui_font_draw_char_buff(bui_ctx_t *ctx, const char *char_buff, uint8_t len, int16_t x, int16_t y,
+		bui_dir_t alignment, bui_font_t font) {
+	bui_font_draw_aligned(ctx, BUI_FONT_DATA_FOR_ID(font), char_buff, len, x, y,
+			bui_font_get_char_buff_width(font, char_buff, len), alignment, NULL);
+}
+
+void bui_font_layout_init(bui_font_layout_t *layout, bui_font_t font, const char *char_buff, uint8_t len,
+		int16_t *offsets) {
+	const bui_font_data_t *font_data = BUI_FONT_DATA_FOR_ID(font);
+	const bui_font_char_t *chars = (const bui_font_char_t*) PIC(font_data->chars);
+	const bui_font_range_t *ranges = (const bui_font_range_t*) PIC(font_data->ranges);
+	uint8_t char_kerning = font_data->info.char_kerning;
+	int16_t x = 0;
+	for (uint8_t i = 0; i < len;) {
+		uint16_t code;
+		uint8_t n_bytes = bui_font_decode_char(&char_buff[i], len - i, &code);
+		offsets[i] = x;
+		const bui_font_char_t *font_char = bui_font_find_char(font_data, chars, ranges, code);
+		if (font_char != NULL) {
+			x += font_char->char_width;
+			x += char_kerning;
+		}
+		// The bytes after the first of a multi-byte character are placed after the character, so that no prefix of the
+		// layout that ends partway through a character is ever selected
+		for (uint8_t j = 1; j < n_bytes; j++)
+			offsets[i + j] = x;
+		i += n_bytes;
+	}
+	offsets[len] = x;
+	layout->font = font;
+	layout->chars = char_buff;
+	layout->offsets = offsets;
+	layout->len = len;
+}
+
+int16_t bui_font_layout_get_width(const bui_font_layout_t *layout, uint8_t n) {
+	return layout->offsets[n];
+}
+
+uint8_t bui_font_layout_fit(const bui_font_layout_t *layout, int16_t w) {
+	// The first n characters fit if offsets[n] - char_kerning <= w, which holds for every n up to some limit since the
+	// offsets never decrease; the limit is found using a binary search
+	int16_t limit = w + bui_font_get_font_info(layout->font)->char_kerning;
+	uint8_t lo = 0, hi = layout->len; // The limit is in [lo, hi]
+	if (w < 0)
+		return 0;
+	while (lo < hi) {
+		uint8_t mid = lo + (hi - lo + 1) / 2;
+		if (layout->offsets[mid] <= limit)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+	return lo;
+}
+
+int16_t bui_font_layout_hit(const bui_font_layout_t *layout, int16_t x) {
+	if (x < 0 || x >= layout->offsets[layout->len])
+		return -1;
+	// Find the last character whose offset is <= x; if several characters share that offset, all but the last are
+	// empty, so the last is the one at x
+	uint8_t lo = 0, hi = layout->len - 1;
+	while (lo < hi) {
+		uint8_t mid = lo + (hi - lo + 1) / 2;
+		if (layout->offsets[mid] <= x)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+	return lo;
+}
+
+void bui_font_layout_draw(bui_ctx_t *ctx, const bui_font_layout_t *layout, uint8_t n, int16_t x, int16_t y,
+		bui_dir_t alignment) {
+	bui_font_draw_aligned(ctx, BUI_FONT_DATA_FOR_ID(layout->font), layout->chars, n, x, y, layout->offsets[n],
+			alignment, NULL);
+}
+
+uint8_t bui_font_wrap_text(bui_font_t font, const char *str, int16_t w, bui_font_line_t *lines, uint8_t max_lines) {
+	const bui_font_data_t *font_data = BUI_FONT_DATA_FOR_ID(font);
+	const bui_font_char_t *chars = (const bui_font_char_t*) PIC(font_data->chars);
+	const bui_font_range_t *ranges = (const bui_font_range_t*) PIC(font_data->ranges);
+	uint8_t char_kerning = font_data->info.char_kerning;
+	uint8_t n = 0;
+	const char *line = str;
+	while (true) {
+		// Measure characters until the end of the line or the first character that does not fit
+		uint8_t len = 0;
+		uint8_t fit_len = 0; // The length of the line if it is wrapped at the last space
+		bool wrappable = false; // True if the line contains a space at which it may be wrapped
+		int16_t line_w = 0;
+		char ch;
+		while (true) {
+			ch = line[len];
+			if (ch == '\0' || ch == '\n')
+				break;
+			uint16_t code;
+			uint8_t n_bytes = bui_font_decode_char(&line[len], 3, &code);
+			if (len + n_bytes > 255)
+				break;
+			if (ch == ' ') {
+				fit_len = len;
+				wrappable = true;
+			}
+			const bui_font_char_t *font_char = bui_font_find_char(font_data, chars, ranges, code);
+			if (font_char != NULL) {
+				line_w += font_char->char_width;
+				if (len != 0 && line_w > w)
+					break;
+				line_w += char_kerning;
+			}
+			len += n_bytes;
+		}
+		bool wrapped = ch != '\0' && ch != '\n';
+		const char *next = line + len + 1;
+		if (wrapped) {
+			next = line + len;
+			if (wrappable) {
+				uint8_t trimmed = fit_len;
+				while (trimmed != 0 && line[trimmed - 1] == ' ')
+					trimmed--;
+				if (trimmed == 0) {
+					// Wrapping at one of the spaces at the start of the line would leave it empty, so the spaces are
+					// skipped instead and the line begins at the word after them
+					const char *word = line + fit_len;
+					while (*word == ' ')
+						word++;
+					if (*word != '\0' && *word != '\n') {
+						line = word;
+						continue;
+					}
+				}
+				len = trimmed;
+				next = line + fit_len;
+			}
+		}
+		if (n < max_lines) {
+			lines[n].start = line - str;
+			lines[n].len = len;
+		}
+		if (n != 255)
+			n++;
+		if (ch == '\0')
+			return n;
+		if (wrapped) {
+			// Omit the spaces at which the line was wrapped, as well as a line break immediately after them
+			while (*next == ' ')
+				next++;
+			if (*next == '\0')
+				return n;
+			if (*next == '\n')
+				next++;
+		}
+		line = next;
+	}
+}
+
+void bui_font_cache_init(bui_font_cache_t *cache, void *arena, uint16_t size) {
+	// Any bytes at the start and end of the arena that can't hold an aligned entry are left unused
+	uint16_t skip = -(uintptr_t) arena % BUI_FONT_CACHE_ALIGN;
+	cache->arena = (uint8_t*) arena + skip;
+	cache->size = size > skip ? (size - skip) & ~(BUI_FONT_CACHE_ALIGN - 1) : 0;
+	cache->used = 0;
+	cache->clock = 0;
+	cache->hits = 0;
+	cache->misses = 0;
+}
+
+void bui_font_cache_clear(bui_font_cache_t *cache) {
+	cache->used = 0;
+}
+
+void bui_font_set_cache(bui_ctx_t *ctx, bui_font_cache_t *cache) {
+	ctx->font_cache = cache;
 }
@@ -0,0 +1,280 @@
+/*
+ * License for the BOLOS User Interface Library project, originally found here:
+ * https://github.com/parkerhoyes/bolos-user-interface
+ *
+ * Copyright (C) 2016, 2017 Parker Hoyes <contact@parkerhoyes.com>
+ *
+ * This software is provided "as-is", without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the
+ * use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not claim
+ *    that you wrote the original software. If you use this software in a
+ *    product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+/*
+ * Definitions shared between the source files of BUI that are not part of its public API.
+ */
+
+#ifndef BUI_INTERNAL_H_
+#define BUI_INTERNAL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bui.h"
+
+// The y-coordinate of the top row of the display held in a BUI context's display buffer
+#if BUI_CTX_BAND_ROWS == 32
+#define BUI_CTX_BAND_TOP(ctx) 0
+#else
+#define BUI_CTX_BAND_TOP(ctx) ((int32_t) (ctx)->band_y)
+#endif
+
+// The y-coordinate just below the bottom row of the display held in a BUI context's display buffer
+#define BUI_CTX_BAND_BOTTOM(ctx) (BUI_CTX_BAND_TOP(ctx) + BUI_CTX_BAND_ROWS)
+
+/*
+ * Perform a bitwise Boolean operation between a source squence of bits and a destination sequence of bits, storing the
+ * result in the destination sequence of bits. The source and destination sequences may not be overlapping. No bytes
+ * that do not contain bits in either of the source or destination sequences are accessed.
+ *
+ * Args:
+ *     src: the pointer to the byte containing the first bit in the source sequence
+ *     src_o: the index of the first bit in the source sequence in its byte (0 for the most significant bit, 7 for the
+ *            least); must be <= 7
+ *     dest: the pointer to the byte containing the first bit in the destination sequence
+ *     dest_o: the index of the first bit in the destination sequence in its byte (0 for the most significant bit, 7 for
+ *             the least); must be <= 7
+ *     n: the number of bits in each of the source and destination sequences
+ */
+typedef void (*bui_bitblit_func_t)(const uint8_t *src, uint8_t src_o, uint8_t *dest, uint8_t dest_o, uint32_t n);
+
+/*
+ * An implementation of bui_bitblit_func_t that performs dest = src.
+ */
+static inline void bui_bitblit_set(const uint8_t *src, uint8_t src_o, uint8_t *dest, uint8_t dest_o, uint32_t n) {
+	while (true) {
+		if (n >= 8) {
+			uint8_t bits = src[0] << src_o;
+			if (src_o != 0)
+				bits |= src[1] >> (8 - src_o);
+			dest[0] &= ~(0xFF >> dest_o);
+			dest[0] |= bits >> dest_o;
+			if (dest_o != 0) {
+				dest[1] &= 0xFF >> dest_o;
+				dest[1] |= bits << (8 - dest_o);
+			}
+			src++;
+			dest++;
+			n -= 8;
+		} else if (n == 0) {
+			break;
+		} else { // n is in [1, 7]
+			uint8_t bits = src[0] << src_o;
+			if (8 - src_o < n)
+				bits |= src[1] >> (8 - src_o);
+			bits &= ~(0xFF >> n);
+			uint8_t mask = ~(0xFF >> n);
+			dest[0] &= ~(mask >> dest_o);
+			dest[0] |= bits >> dest_o;
+			if (8 - dest_o < n) {
+				dest[1] &= ~(mask << (8 - dest_o));
+				dest[1] |= bits << (8 - dest_o);
+			}
+			break;
+		}
+	}
+}
+
+/*
+ * An implementation of bui_bitblit_func_t that performs dest = ~src.
+ */
+static inline void bui_bitblit_not_set(const uint8_t *src, uint8_t src_o, uint8_t *dest, uint8_t dest_o, uint32_t n) {
+	while (true) {
+		if (n >= 8) {
+			uint8_t bits = src[0] << src_o;
+			if (src_o != 0)
+				bits |= src[1] >> (8 - src_o);
+			bits = ~bits;
+			dest[0] &= ~(0xFF >> dest_o);
+			dest[0] |= bits >> dest_o;
+			if (dest_o != 0) {
+				dest[1] &= 0xFF >> dest_o;
+				dest[1] |= bits << (8 - dest_o);
+			}
+			src++;
+			dest++;
+			n -= 8;
+		} else if (n == 0) {
+			break;
+		} else { // n is in [1, 7]
+			uint8_t bits = src[0] << src_o;
+			if (8 - src_o < n)
+				bits |= src[1] >> (8 - src_o);
+			bits &= ~(0xFF >> n);
+			bits = ~bits;
+			uint8_t mask = ~(0xFF >> n);
+			dest[0] &= ~(mask >> dest_o);
+			dest[0] |= bits >> dest_o;
+			if (8 - dest_o < n) {
+				dest[1] &= ~(mask << (8 - dest_o));
+				dest[1] |= bits << (8 - dest_o);
+			}
+			break;
+		}
+	}
+}
+
+/*
+ * An implementation of bui_bitblit_func_t that performs dest = dest | src.
+ */
+static inline void bui_bitblit_or(const uint8_t *src, uint8_t src_o, uint8_t *dest, uint8_t dest_o, uint32_t n) {
+	while (true) {
+		if (n >= 8) {
+			uint8_t bits = src[0] << src_o;
+			if (src_o != 0)
+				bits |= src[1] >> (8 - src_o);
+			dest[0] |= bits >> dest_o;
+			if (dest_o != 0) {
+				dest[1] |= bits << (8 - dest_o);
+			}
+			src++;
+			dest++;
+			n -= 8;
+		} else if (n == 0) {
+			break;
+		} else { // n is in [1, 7]
+			uint8_t bits = src[0] << src_o;
+			if (8 - src_o < n)
+				bits |= src[1] >> (8 - src_o);
+			bits &= ~(0xFF >> n);
+			dest[0] |= bits >> dest_o;
+			if (8 - dest_o < n) {
+				dest[1] |= bits << (8 - dest_o);
+			}
+			break;
+		}
+	}
+}
+
+/*
+ * An implementation of bui_bitblit_func_t that performs dest = dest & src.
+ */
+static inline void bui_bitblit_and(const uint8_t *src, uint8_t src_o, uint8_t *dest, uint8_t dest_o, uint32_t n) {
+	while (true) {
+		if (n >= 8) {
+			uint8_t bits = src[0] << src_o;
+			if (src_o != 0)
+				bits |= src[1] >> (8 - src_o);
+			dest[0] &= bits >> dest_o;
+			if (dest_o != 0) {
+				dest[1] &= bits << (8 - dest_o);
+			}
+			src++;
+			dest++;
+			n -= 8;
+		} else if (n == 0) {
+			break;
+		} else { // n is in [1, 7]
+			uint8_t bits = src[0] << src_o;
+			if (8 - src_o < n)
+				bits |= src[1] >> (8 - src_o);
+			bits &= ~(0xFF >> n);
+			dest[0] &= bits >> dest_o;
+			if (8 - dest_o < n) {
+				dest[1] &= bits << (8 - dest_o);
+			}
+			break;
+		}
+	}
+}
+
+/*
+ * An implementation of bui_bitblit_func_t that performs dest = dest | ~src.
+ */
+static inline void bui_bitblit_or_not(const uint8_t *src, uint8_t src_o, uint8_t *dest, uint8_t dest_o, uint32_t n) {
+	while (true) {
+		if (n >= 8) {
+			uint8_t bits = src[0] << src_o;
+			if (src_o != 0)
+				bits |= src[1] >> (8 - src_o);
+			dest[0] |= ~(bits >> dest_o);
+			if (dest_o != 0) {
+				dest[1] |= ~(bits << (8 - dest_o));
+			}
+			src++;
+			dest++;
+			n -= 8;
+		} else if (n == 0) {
+			break;
+		} else { // n is in [1, 7]
+			uint8_t bits = src[0] << src_o;
+			if (8 - src_o < n)
+				bits |= src[1] >> (8 - src_o);
+			bits &= ~(0xFF >> n);
+			dest[0] |= ~(bits >> dest_o);
+			if (8 - dest_o < n) {
+				dest[1] |= ~(bits << (8 - dest_o));
+			}
+			break;
+		}
+	}
+}
+
+/*
+ * An implementation of bui_bitblit_func_t that performs dest = dest & ~src.
+ */
+static inline void bui_bitblit_and_not(const uint8_t *src, uint8_t src_o, uint8_t *dest, uint8_t dest_o, uint32_t n) {
+	while (true) {
+		if (n >= 8) {
+			uint8_t bits = src[0] << src_o;
+			if (src_o != 0)
+				bits |= src[1] >> (8 - src_o);
+			dest[0] &= ~(bits >> dest_o);
+			if (dest_o != 0) {
+				dest[1] &= ~(bits << (8 - dest_o));
+			}
+			src++;
+			dest++;
+			n -= 8;
+		} else if (n == 0) {
+			break;
+		} else { // n is in [1, 7]
+			uint8_t bits = src[0] << src_o;
+			if (8 - src_o < n)
+				bits |= src[1] >> (8 - src_o);
+			bits &= ~(0xFF >> n);
+			dest[0] &= ~(bits >> dest_o);
+			if (8 - dest_o < n) {
+				dest[1] &= ~(bits << (8 - dest_o));
+			}
+			break;
+		}
+	}
+}
+
+/*
+ * Extend the provided BUI context's dirty rectangle for its current draw priority by the minimum amount such that it
+ * encloses the provided rectangle. The provided rectangle must be entirely within the display's coordinate plane. In
+ * band mode, this has no effect.
+ *
+ * Args:
+ *     ctx: the BUI context
+ *     x: the x-coordinate of the top-left corner of the rectangle
+ *     y: the y-coordinate of the top-left corner of the rectangle
+ *     w: the width of the rectangle; must be != 0
+ *     h: the height of the rectangle; must be != 0
+ */
+void bui_ctx_dirty(bui_ctx_t *ctx, uint8_t x, uint8_t y, uint8_t w, uint8_t h);
+
+#endif
@@ -85,6 +85,11 @@ bool bui_menu_animate(bui_menu_menu_t *menu, uint32_t elapsed) {
 	return true;
 }
 
+void bui_menu_request_ticker(const bui_menu_menu_t *menu, bui_ctx_t *ctx) {
+	if (menu->animations && menu->scroll_pos != 0)
+		bui_ctx_request_ticker(ctx, 0);
+}
+
 void bui_menu_draw(const bui_menu_menu_t *menu, bui_ctx_t *ctx) {
 	uint8_t count = menu->count;
 	if (count == 0)
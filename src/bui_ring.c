@@ -0,0 +1,73 @@
+/*
+ * License for the BOLOS User Interface Library project, originally found here:
+ * https://github.com/parkerhoyes/bolos-user-interface
+ *
+ * Copyright (C) 2016, 2017 Parker Hoyes <contact@parkerhoyes.com>
+ *
+ * This software is provided "as-is", without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from the
+ * use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not claim
+ *    that you wrote the original software. If you use this software in a
+ *    product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ */
+
+#include "bui_ring.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bui.h"
+
+#ifndef __STDC_NO_ATOMICS__
+
+#include <stdatomic.h>
+
+void bui_ring_init(bui_ring_t *ring) {
+	atomic_init(&ring->head, 0);
+	atomic_init(&ring->tail, 0);
+}
+
+bool bui_ring_push(bui_ring_t *ring, const bui_input_event_t *event) {
+	uint8_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	// Acquiring the head ensures the consumer is done reading the slot before it is overwritten
+	uint8_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+	if ((uint8_t) (tail - head) == BUI_RING_SIZE)
+		return false;
+	ring->events[tail % BUI_RING_SIZE] = *event;
+	// Releasing the tail publishes the event to the consumer
+	atomic_store_explicit(&ring->tail, (uint8_t) (tail + 1), memory_order_release);
+	return true;
+}
+
+bool bui_ring_pop(bui_ring_t *ring, bui_input_event_t *event) {
+	uint8_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	uint8_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+	if (head == tail)
+		return false;
+	*event = ring->events[head % BUI_RING_SIZE];
+	atomic_store_explicit(&ring->head, (uint8_t) (head + 1), memory_order_release);
+	return true;
+}
+
+uint8_t bui_ring_drain(bui_ring_t *ring, bui_ctx_t *ctx) {
+	uint8_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	uint8_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+	uint8_t count = tail - head;
+	for (; head != tail; head++)
+		bui_ctx_queue_input_event(ctx, &ring->events[head % BUI_RING_SIZE]);
+	// The slots are only released to the producer once every event has been queued
+	atomic_store_explicit(&ring->head, tail, memory_order_release);
+	return count;
+}
+
+#endif
@@ -159,42 +159,86 @@ void bui_room_dispatch_event(bui_room_ctx_t *ctx, const bui_room_event_t *event)
 }
 
 void bui_room_forward_event(bui_room_ctx_t *ctx, const bui_event_t *bui_event) {
+	if ((bui_room_get_current(ctx)->ignored_events & BUI_EVENT_MASK(bui_event->id)) != 0)
+		return;
 	bui_room_event_t event = { .id = BUI_ROOM_EVENT_FORWARD, .data = bui_event };
 	bui_room_dispatch_event(ctx, &event);
 }
 
+void bui_room_handle_bui_event(bui_room_ctx_t *ctx, bui_ctx_t *bui_ctx, const bui_event_t *bui_event) {
+#if BUI_CTX_BAND_ROWS == 32
+	if (bui_event->id == BUI_EVENT_FRAME_READY) {
+		bui_ctx_fill(bui_ctx, BUI_CLR_BLACK);
+		bui_room_event_data_draw_t data = { .bui_ctx = bui_ctx };
+		bui_room_event_t event = { .id = BUI_ROOM_EVENT_DRAW, .data = &data };
+		bui_room_dispatch_event(ctx, &event);
+		return;
+	}
+#endif
+	const void *frame_ptr = ctx->frame_ptr;
+	const bui_room_t *room = bui_room_get_current(ctx);
+	bui_room_forward_event(ctx, bui_event);
+	// A room entered or exited while handling the event is only drawn if a new frame is requested
+	if (ctx->frame_ptr != frame_ptr || bui_room_get_current(ctx) != room)
+		bui_ctx_request_frame(bui_ctx);
+}
+
+// The lines of text displayed by the message and confirm rooms, which are stored in their stack frames just after their
+// arguments so that the text is only wrapped once
+typedef struct __attribute__((packed)) {
+	uint8_t n_lines; // The number of lines
+	bui_font_line_t lines[]; // The lines, in order
+} bui_room_text_t;
+
+/*
+ * Wrap a message to the specified width and push the resulting bui_room_text_t onto the top of the stack.
+ *
+ * Args:
+ *     ctx: the room context
+ *     msg: the message, as a null-terminated string
+ *     font: the font in which the message is to be drawn
+ *     w: the maximum width of each line of the message, in pixels
+ */
+static void bui_room_text_wrap(bui_room_ctx_t *ctx, const char *msg, bui_font_t font, int16_t w) {
+	uint8_t n_lines = bui_font_wrap_text(font, msg, w, NULL, 0);
+	bui_room_text_t *text = bui_room_alloc(ctx, sizeof(bui_room_text_t) + n_lines * sizeof(bui_font_line_t));
+	text->n_lines = bui_font_wrap_text(font, msg, w, text->lines, n_lines);
+}
+
+/*
+ * Draw the lines of a wrapped message centered on the display.
+ *
+ * Args:
+ *     text: the lines of the message, as produced by bui_room_text_wrap(...)
+ *     msg: the message, as a null-terminated string
+ *     font: the font in which the message is to be drawn
+ *     bui_ctx: the BUI context in which the message is to be drawn
+ */
+static void bui_room_text_draw(const bui_room_text_t *text, const char *msg, bui_font_t font, bui_ctx_t *bui_ctx) {
+	uint8_t char_height = bui_font_get_font_info(font)->char_height;
+	int16_t y = -((int16_t) text->n_lines * (char_height + 1) - 1) / 2 + 16;
+	for (uint8_t i = 0; i < text->n_lines && y < 32; i++) {
+		if (y + char_height > 0)
+			bui_font_draw_char_buff(bui_ctx, msg + text->lines[i].start, text->lines[i].len, 64, y, BUI_DIR_TOP, font);
+		y += char_height + 1;
+	}
+}
+
 static void bui_room_message_handle_event(bui_room_ctx_t *ctx, const bui_room_event_t *event) {
 	switch (event->id) {
+	case BUI_ROOM_EVENT_ENTER: {
+		if (BUI_ROOM_EVENT_DATA_ENTER(event)->up) {
+			bui_room_message_args_t *args = ctx->frame_ptr;
+			bui_room_text_wrap(ctx, args->msg, args->font, 128);
+		}
+	} break;
 	case BUI_ROOM_EVENT_EXIT: {
 		bui_room_dealloc_frame(ctx);
 	} break;
 	case BUI_ROOM_EVENT_DRAW: {
 		const bui_room_event_data_draw_t *data = BUI_ROOM_EVENT_DATA_DRAW(event);
 		bui_room_message_args_t *args = ctx->frame_ptr;
-		uint8_t char_height = bui_font_get_font_info(args->font)->char_height;
-		uint8_t n_lines = 1;
-		for (const char *ch = args->msg; *ch != '\0'; ch++) {
-			if (*ch == '\n')
-				n_lines++;
-		}
-		int16_t y = -((int16_t) n_lines * (char_height + 1) - 1) / 2 + 16;
-		bool last_line = false;
-		for (const char *line = args->msg; !last_line;) {
-			uint8_t line_len = 0;
-			for (;; line_len++) {
-				if (line[line_len] == '\0') {
-					last_line = true;
-					break;
-				}
-				if (line[line_len] == '\n') {
-					last_line = false;
-					break;
-				}
-			}
-			bui_font_draw_char_buff(data->bui_ctx, line, line_len, 64, y, BUI_DIR_TOP, args->font);
-			line += line_len + 1;
-			y += char_height + 1;
-		}
+		bui_room_text_draw((const bui_room_text_t*) (args + 1), args->msg, args->font, data->bui_ctx);
 	} break;
 	case BUI_ROOM_EVENT_FORWARD: {
 		const bui_event_t *bui_event = BUI_ROOM_EVENT_DATA_FORWARD(event);
@@ -217,10 +261,19 @@ static void bui_room_message_handle_event(bui_room_ctx_t *ctx, const bui_room_ev
 
 const bui_room_t bui_room_message = {
 	.event_handler = bui_room_message_handle_event,
+	// Only clicks are handled
+	.ignored_events = (bui_event_mask_t) ~BUI_EVENT_MASK(BUI_EVENT_BUTTON_CLICKED),
 };
 
 static void bui_room_confirm_handle_event(bui_room_ctx_t *ctx, const bui_room_event_t *event) {
 	switch (event->id) {
+	case BUI_ROOM_EVENT_ENTER: {
+		if (BUI_ROOM_EVENT_DATA_ENTER(event)->up) {
+			bui_room_confirm_args_t *args = ctx->frame_ptr;
+			// The text is kept clear of the check and cross icons on either side
+			bui_room_text_wrap(ctx, args->msg, args->font, 100);
+		}
+	} break;
 	case BUI_ROOM_EVENT_EXIT: {
 		bui_room_confirm_ret_t ret;
 		bui_room_pop(ctx, &ret.confirmed, sizeof(bool));
@@ -231,32 +284,7 @@ static void bui_room_confirm_handle_event(bui_room_ctx_t *ctx, const bui_room_ev
 		const bui_room_event_data_draw_t *data = BUI_ROOM_EVENT_DATA_DRAW(event);
 		bui_room_confirm_args_t *args = ctx->frame_ptr;
 		// Draw text
-		{
-			uint8_t char_height = bui_font_get_font_info(args->font)->char_height;
-			uint8_t n_lines = 1;
-			for (const char *ch = args->msg; *ch != '\0'; ch++) {
-				if (*ch == '\n')
-					n_lines++;
-			}
-			int16_t y = -((int16_t) n_lines * (char_height + 1) - 1) / 2 + 16;
-			bool last_line = false;
-			for (const char *line = args->msg; !last_line;) {
-				uint8_t line_len = 0;
-				for (;; line_len++) {
-					if (line[line_len] == '\0') {
-						last_line = true;
-						break;
-					}
-					if (line[line_len] == '\n') {
-						last_line = false;
-						break;
-					}
-				}
-				bui_font_draw_char_buff(data->bui_ctx, line, line_len, 64, y, BUI_DIR_TOP, args->font);
-				line += line_len + 1;
-				y += char_height + 1;
-			}
-		}
+		bui_room_text_draw((const bui_room_text_t*) (args + 1), args->msg, args->font, data->bui_ctx);
 		// Draw check & cross icons
 		bui_ctx_draw_bitmap_full(data->bui_ctx, BUI_BMP_ICON_CROSS, 3, 12);
 		bui_ctx_draw_bitmap_full(data->bui_ctx, BUI_BMP_ICON_CHECK, 117, 13);
@@ -285,4 +313,6 @@ static void bui_room_confirm_handle_event(bui_room_ctx_t *ctx, const bui_room_ev
 
 const bui_room_t bui_room_confirm = {
 	.event_handler = bui_room_confirm_handle_event,
+	// Only clicks are handled
+	.ignored_events = (bui_event_mask_t) ~BUI_EVENT_MASK(BUI_EVENT_BUTTON_CLICKED),
 };